@@ -29,6 +29,8 @@ typedef khronos_uint8_t GLubyte;
 typedef khronos_ssize_t GLsizeiptr;
 typedef khronos_intptr_t GLintptr;
 typedef char GLchar;
+typedef khronos_uint64_t GLuint64;
+typedef struct __GLsync *GLsync;
 
 /* OpenGL Constants */
 #define GL_FALSE 0
@@ -60,6 +62,23 @@ typedef char GLchar;
 #define GL_SRC_ALPHA 0x0302
 #define GL_ONE_MINUS_SRC_ALPHA 0x0303
 #define GL_TEXTURE0 0x84C0
+#define GL_STREAM_DRAW 0x88E0
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_UNSIGNED_SHORT 0x1403
+#define GL_TEXTURE_2D_ARRAY 0x8C1A
+#define GL_RGBA8 0x8058
+#define GL_ONE 1
+#define GL_MAP_WRITE_BIT 0x0002
+#define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_WAIT_FAILED 0x911D
 
 /* OpenGL Functions */
 typedef void(KHRONOS_APIENTRY *PFNGLCLEARPROC)(GLbitfield mask);
@@ -148,6 +167,52 @@ typedef void(KHRONOS_APIENTRY *PFNGLUNIFORMMATRIX4FVPROC)(GLint location,
                                                           GLsizei count,
                                                           GLboolean transpose,
                                                           const GLfloat *value);
+typedef void(KHRONOS_APIENTRY *PFNGLBUFFERSUBDATAPROC)(GLenum target,
+                                                       GLintptr offset,
+                                                       GLsizeiptr size,
+                                                       const void *data);
+typedef void(KHRONOS_APIENTRY *PFNGLDRAWELEMENTSINSTANCEDPROC)(
+    GLenum mode, GLsizei count, GLenum type, const void *indices,
+    GLsizei instancecount);
+typedef void(KHRONOS_APIENTRY *PFNGLVERTEXATTRIBDIVISORPROC)(GLuint index,
+                                                             GLuint divisor);
+typedef void(KHRONOS_APIENTRY *PFNGLDISABLEPROC)(GLenum cap);
+typedef void(KHRONOS_APIENTRY *PFNGLUNIFORM4FPROC)(GLint location, GLfloat v0,
+                                                   GLfloat v1, GLfloat v2,
+                                                   GLfloat v3);
+typedef void(KHRONOS_APIENTRY *PFNGLTEXIMAGE3DPROC)(GLenum target, GLint level,
+                                                    GLint internalformat,
+                                                    GLsizei width,
+                                                    GLsizei height,
+                                                    GLsizei depth, GLint border,
+                                                    GLenum format, GLenum type,
+                                                    const void *pixels);
+typedef void(KHRONOS_APIENTRY *PFNGLTEXSUBIMAGE3DPROC)(GLenum target,
+                                                       GLint level,
+                                                       GLint xoffset,
+                                                       GLint yoffset,
+                                                       GLint zoffset,
+                                                       GLsizei width,
+                                                       GLsizei height,
+                                                       GLsizei depth,
+                                                       GLenum format,
+                                                       GLenum type,
+                                                       const void *pixels);
+typedef void *(KHRONOS_APIENTRY *PFNGLMAPBUFFERRANGEPROC)(GLenum target,
+                                                          GLintptr offset,
+                                                          GLsizeiptr length,
+                                                          GLbitfield access);
+typedef GLboolean(KHRONOS_APIENTRY *PFNGLUNMAPBUFFERPROC)(GLenum target);
+typedef GLsync(KHRONOS_APIENTRY *PFNGLFENCESYNCPROC)(GLenum condition,
+                                                     GLbitfield flags);
+typedef GLenum(KHRONOS_APIENTRY *PFNGLCLIENTWAITSYNCPROC)(GLsync sync,
+                                                          GLbitfield flags,
+                                                          GLuint64 timeout);
+typedef void(KHRONOS_APIENTRY *PFNGLDELETESYNCPROC)(GLsync sync);
+typedef void(KHRONOS_APIENTRY *PFNGLBUFFERSTORAGEPROC)(GLenum target,
+                                                       GLsizeiptr size,
+                                                       const void *data,
+                                                       GLbitfield flags);
 
 extern PFNGLCLEARPROC glad_glClear;
 #define glClear glad_glClear
@@ -231,6 +296,32 @@ extern PFNGLACTIVETEXTUREPROC glad_glActiveTexture;
 #define glActiveTexture glad_glActiveTexture
 extern PFNGLUNIFORMMATRIX4FVPROC glad_glUniformMatrix4fv;
 #define glUniformMatrix4fv glad_glUniformMatrix4fv
+extern PFNGLBUFFERSUBDATAPROC glad_glBufferSubData;
+#define glBufferSubData glad_glBufferSubData
+extern PFNGLDRAWELEMENTSINSTANCEDPROC glad_glDrawElementsInstanced;
+#define glDrawElementsInstanced glad_glDrawElementsInstanced
+extern PFNGLVERTEXATTRIBDIVISORPROC glad_glVertexAttribDivisor;
+#define glVertexAttribDivisor glad_glVertexAttribDivisor
+extern PFNGLDISABLEPROC glad_glDisable;
+#define glDisable glad_glDisable
+extern PFNGLUNIFORM4FPROC glad_glUniform4f;
+#define glUniform4f glad_glUniform4f
+extern PFNGLTEXIMAGE3DPROC glad_glTexImage3D;
+#define glTexImage3D glad_glTexImage3D
+extern PFNGLTEXSUBIMAGE3DPROC glad_glTexSubImage3D;
+#define glTexSubImage3D glad_glTexSubImage3D
+extern PFNGLMAPBUFFERRANGEPROC glad_glMapBufferRange;
+#define glMapBufferRange glad_glMapBufferRange
+extern PFNGLUNMAPBUFFERPROC glad_glUnmapBuffer;
+#define glUnmapBuffer glad_glUnmapBuffer
+extern PFNGLFENCESYNCPROC glad_glFenceSync;
+#define glFenceSync glad_glFenceSync
+extern PFNGLCLIENTWAITSYNCPROC glad_glClientWaitSync;
+#define glClientWaitSync glad_glClientWaitSync
+extern PFNGLDELETESYNCPROC glad_glDeleteSync;
+#define glDeleteSync glad_glDeleteSync
+extern PFNGLBUFFERSTORAGEPROC glad_glBufferStorage;
+#define glBufferStorage glad_glBufferStorage
 
 #ifdef __cplusplus
 }
@@ -42,6 +42,19 @@ PFNGLENABLEPROC glad_glEnable = NULL;
 PFNGLBLENDFUNCPROC glad_glBlendFunc = NULL;
 PFNGLACTIVETEXTUREPROC glad_glActiveTexture = NULL;
 PFNGLUNIFORMMATRIX4FVPROC glad_glUniformMatrix4fv = NULL;
+PFNGLBUFFERSUBDATAPROC glad_glBufferSubData = NULL;
+PFNGLDRAWELEMENTSINSTANCEDPROC glad_glDrawElementsInstanced = NULL;
+PFNGLVERTEXATTRIBDIVISORPROC glad_glVertexAttribDivisor = NULL;
+PFNGLDISABLEPROC glad_glDisable = NULL;
+PFNGLUNIFORM4FPROC glad_glUniform4f = NULL;
+PFNGLTEXIMAGE3DPROC glad_glTexImage3D = NULL;
+PFNGLTEXSUBIMAGE3DPROC glad_glTexSubImage3D = NULL;
+PFNGLMAPBUFFERRANGEPROC glad_glMapBufferRange = NULL;
+PFNGLUNMAPBUFFERPROC glad_glUnmapBuffer = NULL;
+PFNGLFENCESYNCPROC glad_glFenceSync = NULL;
+PFNGLCLIENTWAITSYNCPROC glad_glClientWaitSync = NULL;
+PFNGLDELETESYNCPROC glad_glDeleteSync = NULL;
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = NULL;
 
 int gladLoadGLLoader(GLADloadproc load) {
   glad_glClear = (PFNGLCLEARPROC)load("glClear");
@@ -92,5 +105,20 @@ int gladLoadGLLoader(GLADloadproc load) {
   glad_glActiveTexture = (PFNGLACTIVETEXTUREPROC)load("glActiveTexture");
   glad_glUniformMatrix4fv =
       (PFNGLUNIFORMMATRIX4FVPROC)load("glUniformMatrix4fv");
+  glad_glBufferSubData = (PFNGLBUFFERSUBDATAPROC)load("glBufferSubData");
+  glad_glDrawElementsInstanced =
+      (PFNGLDRAWELEMENTSINSTANCEDPROC)load("glDrawElementsInstanced");
+  glad_glVertexAttribDivisor =
+      (PFNGLVERTEXATTRIBDIVISORPROC)load("glVertexAttribDivisor");
+  glad_glDisable = (PFNGLDISABLEPROC)load("glDisable");
+  glad_glUniform4f = (PFNGLUNIFORM4FPROC)load("glUniform4f");
+  glad_glTexImage3D = (PFNGLTEXIMAGE3DPROC)load("glTexImage3D");
+  glad_glTexSubImage3D = (PFNGLTEXSUBIMAGE3DPROC)load("glTexSubImage3D");
+  glad_glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)load("glMapBufferRange");
+  glad_glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)load("glUnmapBuffer");
+  glad_glFenceSync = (PFNGLFENCESYNCPROC)load("glFenceSync");
+  glad_glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)load("glClientWaitSync");
+  glad_glDeleteSync = (PFNGLDELETESYNCPROC)load("glDeleteSync");
+  glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
   return 1;
 }
@@ -0,0 +1,31 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <algorithm>
+
+// Axis-aligned box in world units
+struct Aabb {
+    float minX, minY, maxX, maxY;
+
+    static Aabb Around(float x, float y, float halfW, float halfH) {
+        return {x - halfW, y - halfH, x + halfW, y + halfH};
+    }
+    bool IsEmpty() const { return minX > maxX || minY > maxY; }
+    bool Overlaps(const Aabb& o) const {
+        return minX < o.maxX && o.minX < maxX && minY < o.maxY && o.minY < maxY;
+    }
+    // Whether the segment from (x, y) to (x + dx, y + dy) passes through it
+    bool Crosses(float x, float y, float dx, float dy) const {
+        float enter = 0, exit = 1;
+        auto slab = [&](float o, float d, float lo, float hi) {
+            if (d == 0) return lo <= o && o <= hi;
+            float t0 = (lo - o) / d, t1 = (hi - o) / d;
+            enter = std::max(enter, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+            return enter <= exit;
+        };
+        return slab(x, dx, minX, maxX) && slab(y, dy, minY, maxY);
+    }
+};
+
+#endif
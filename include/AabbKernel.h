@@ -0,0 +1,42 @@
+#ifndef AABBKERNEL_H
+#define AABBKERNEL_H
+
+#include <cstdint>
+#include <vector>
+#include "SpatialHash.h"
+
+// Candidate boxes in structure-of-arrays form, padded to whole blocks of 8.
+// Empty boxes and padding are stored as NaN so they never overlap anything.
+struct AabbSoA {
+    static const int kBlock = 8;
+
+    std::vector<float> minX, minY, maxX, maxY;
+    int count = 0;
+
+    void Clear();
+    void Push(const Aabb& box);
+    int Blocks() const { return (int)minX.size() / kBlock; }
+};
+
+// Tests one box against every box of an AabbSoA, 8 at a time
+namespace AabbKernel {
+
+enum class Isa {
+    Scalar,
+    SSE,
+    AVX2
+};
+
+// Best instruction set the CPU supports, chosen on first use
+Isa Active();
+// Forces a path for benchmarking; clamped to what the CPU supports
+void Select(Isa isa);
+const char* Name(Isa isa);
+
+// masks[b] bit i is set when `box` overlaps candidate b * 8 + i
+void OverlapMasks(const Aabb& box, const AabbSoA& soa, std::vector<uint8_t>& masks);
+bool AnyOverlap(const Aabb& box, const AabbSoA& soa);
+
+} // namespace AabbKernel
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef AABBTREE_H
+#define AABBTREE_H
+
+#include <vector>
+#include "Aabb.h"
+
+// Dynamic bounding volume tree. Leaves store boxes fattened by kMargin so a
+// body that moves a little needs no tree update; when it leaves its fat box
+// the leaf is reinserted where it grows the tree least, and rotations keep
+// the tree balanced. Proxies are node indices and stay valid until destroyed.
+class AabbTree {
+public:
+    static constexpr float kMargin = 0.1f;
+
+    AabbTree();
+
+    int CreateProxy(const Aabb& box, int userId);
+    void DestroyProxy(int proxy);
+    // Returns true if the leaf had to be reinserted
+    bool MoveProxy(int proxy, const Aabb& box);
+    void Clear();
+
+    const Aabb& FatBox(int proxy) const { return nodes[proxy].box; }
+    int Height() const { return root < 0 ? 0 : nodes[root].height; }
+
+    // Calls visit(userId) for every leaf whose fat box overlaps `box`
+    template <typename F>
+    void Query(const Aabb& box, F&& visit) const {
+        if (root < 0) return;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const Node &n = nodes[stack.back()];
+            stack.pop_back();
+            if (!n.box.Overlaps(box)) continue;
+            if (n.IsLeaf()) {
+                visit(n.userId);
+            } else {
+                stack.push_back(n.child1);
+                stack.push_back(n.child2);
+            }
+        }
+    }
+
+    // Calls visit(userId) for every leaf whose fat box the segment from
+    // (x, y) to (x + dx, y + dy) crosses
+    template <typename F>
+    void RayQuery(float x, float y, float dx, float dy, F&& visit) const {
+        if (root < 0) return;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const Node &n = nodes[stack.back()];
+            stack.pop_back();
+            if (!n.box.Crosses(x, y, dx, dy)) continue;
+            if (n.IsLeaf()) {
+                visit(n.userId);
+            } else {
+                stack.push_back(n.child1);
+                stack.push_back(n.child2);
+            }
+        }
+    }
+
+private:
+    struct Node {
+        Aabb box;
+        int parent; // next free node while on the free list
+        int child1, child2;
+        int height; // leaves are 0, free nodes -1
+        int userId;
+
+        bool IsLeaf() const { return child1 < 0; }
+    };
+
+    std::vector<Node> nodes;
+    int root;
+    int freeList;
+    mutable std::vector<int> stack;
+
+    int AllocateNode();
+    void FreeNode(int node);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int Balance(int node);
+    void Refit(int node);
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <memory>
+#include <vector>
+#include "AabbTree.h"
+#include "SpatialHash.h"
+
+enum class BroadphaseType {
+    BruteForce, // every body against every other, the old behaviour
+    SpatialHash, // uniform grid
+    AabbTree,    // dynamic bounding volume tree
+    SweepAndPrune // persistent sorted X endpoints
+};
+
+// Every broadphase in enum order, which is also the editor combo order
+inline constexpr BroadphaseType kBroadphaseTypes[] = {BroadphaseType::BruteForce, BroadphaseType::SpatialHash, BroadphaseType::AabbTree,
+                                                     BroadphaseType::SweepAndPrune};
+
+// Two overlapping ids, a < b
+struct OverlapPair {
+    int a, b;
+
+    bool operator<(const OverlapPair& o) const { return a != o.a ? a < o.a : b < o.b; }
+    bool operator==(const OverlapPair& o) const { return a == o.a && b == o.b; }
+};
+
+// Narrows collision candidates down before the exact test. Ids are indices
+// into the box list given to Update; empty boxes never match.
+class Broadphase {
+public:
+    virtual ~Broadphase() = default;
+
+    virtual void Update(const std::vector<Aabb>& boxes) = 0;
+    // Appends the id of every box overlapping `box`, each once
+    virtual void Query(const Aabb& box, std::vector<int>& out) = 0;
+    // Appends, each once, the id of every box the segment from (x, y) to
+    // (x + dx, y + dy) may cross. By default that is whatever overlaps the
+    // segment's bounds; a broadphase that can follow the ray does better.
+    virtual void RayQuery(float x, float y, float dx, float dy, std::vector<int>& out);
+
+    static std::unique_ptr<Broadphase> Create(BroadphaseType type);
+    static const char* Name(BroadphaseType type);
+};
+
+class BruteForceBroadphase : public Broadphase {
+public:
+    void Update(const std::vector<Aabb>& boxes) override;
+    void Query(const Aabb& box, std::vector<int>& out) override;
+
+private:
+    std::vector<int> ids; // non-empty boxes
+};
+
+class SpatialHashBroadphase : public Broadphase {
+public:
+    explicit SpatialHashBroadphase(float cellSize = 0.5f) : hash(cellSize) {}
+
+    void Update(const std::vector<Aabb>& boxes) override { hash.Build(boxes); }
+    void Query(const Aabb& box, std::vector<int>& out) override { hash.Query(box, out); }
+
+private:
+    SpatialHash hash;
+};
+
+// Keeps one tree proxy per id and only touches the ones whose box changed,
+// so mostly-static scenes update in O(moved * log n)
+class AabbTreeBroadphase : public Broadphase {
+public:
+    void Update(const std::vector<Aabb>& boxes) override;
+    void Query(const Aabb& box, std::vector<int>& out) override;
+    // Walks only the tree nodes the segment crosses
+    void RayQuery(float x, float y, float dx, float dy, std::vector<int>& out) override;
+
+    int Height() const { return tree.Height(); }
+
+private:
+    AabbTree tree;
+    std::vector<Aabb> tight; // last box per id, fat boxes only narrow the search
+    std::vector<int> proxies; // per id, -1 if not in the tree
+};
+
+#endif
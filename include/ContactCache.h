@@ -0,0 +1,66 @@
+#ifndef CONTACTCACHE_H
+#define CONTACTCACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "ObbKernel.h"
+
+struct ContactPoint {
+    float x, y;           // world position, midway between the two outlines
+    float separation;     // along the normal; negative when penetrating
+    float normalImpulse;  // accumulated over the step, kept for warm starting
+    float tangentImpulse; // friction, accumulated the same way
+    float normalMass, tangentMass;
+    float targetSpeed;    // normal speed the solver drives towards
+    int id;               // which half of the shared edge it stands for, to match across steps
+};
+
+// Touching region of two boxes. The normal is along whichever world axis
+// the boxes penetrate least, pointing from b to a, even when a box is
+// rotated; the points are then where the gap between the facing outlines
+// is smallest.
+struct Manifold {
+    int a, b;
+    // When b is static world geometry rather than an entity: which piece
+    // (0 the floor, else a tile rect id) and its box as last found
+    uint32_t part = 0;
+    Obb piece = {};
+    float normalX = 0, normalY = 0; // one is 0, the other +1 or -1
+    int count = 0;
+    ContactPoint points[2];
+    uint32_t stamp = 0; // step the pair was last found in
+    // How each point's normal impulse moves both points' normal speeds;
+    // with two points these are solved together when well conditioned
+    float k11 = 0, k12 = 0, k22 = 0;
+    bool block = false;
+
+    // Recomputes the points, carrying impulses over by id; count is 0 once
+    // the boxes share neither an X nor a Y interval
+    void Update(const Obb& boxA, const Obb& boxB);
+};
+
+// Manifolds that outlive a step, keyed by body pair, so the solver can
+// start from last step's impulses instead of zero
+class ContactCache {
+public:
+    // Opens a step; pairs not touched before End are dropped
+    void Begin();
+    // Finds or creates the manifold for a, b and b's part; fresh is set
+    // when it is new. Parts of one b must have distinct ids.
+    Manifold& Touch(int a, int b, uint32_t part, bool& fresh);
+    void End();
+    void Clear();
+
+    // Manifolds touched this step, ordered by pair so solving is repeatable
+    std::vector<Manifold*>& Active() { return active; }
+
+private:
+    std::unordered_map<uint64_t, Manifold> pairs;
+    std::vector<Manifold*> active;
+    uint32_t stamp = 0;
+
+    static uint64_t Key(int a, int b, uint32_t part);
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef CONTACTISLANDS_H
+#define CONTACTISLANDS_H
+
+#include <cstdint>
+#include <vector>
+#include "ContactCache.h"
+
+// Splits manifolds into islands: groups whose moving bodies touch each
+// other, directly or through a chain. Statics and sleeping bodies don't
+// join islands since the solver never changes their velocity, so
+// different islands can be solved at the same time.
+class ContactIslands {
+public:
+    // Islands are numbered by their first manifold and keep the input's
+    // order, so the grouping doesn't depend on who solves them
+    void Build(int bodyCount, const std::vector<Manifold*>& manifolds, const std::vector<uint8_t>& moving);
+
+    int Count() const { return (int)starts.size() - 1; }
+    Manifold* const* Begin(int island) const { return order.data() + starts[island]; }
+    int Size(int island) const { return starts[island + 1] - starts[island]; }
+    // Island of a moving body, or -1 if it touches nothing
+    int IslandOf(int body) const { return bodyIsland[body]; }
+
+private:
+    std::vector<int> parent; // union-find over body indices
+    std::vector<int> label;  // per root, its island
+    std::vector<int> manifoldIsland;
+    std::vector<int> bodyIsland;
+    std::vector<int> starts;
+    std::vector<int> cursor; // write heads for the counting sort
+    std::vector<Manifold*> order;
+
+    int Find(int x);
+};
+
+#endif
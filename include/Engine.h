@@ -2,8 +2,12 @@
 #define ENGINE_H
 
 #include <SDL.h>
+#include <cstdint>
+#include <utility>
 #include <vector>
 #include "Entity.h"
+#include "PhysicsThread.h"
+#include "PhysicsWorld.h"
 #include "Renderer.h"
 
 class Engine {
@@ -13,6 +17,9 @@ public:
 
     void Init();
     void Run();
+    // Steps a fixed scene headless under each broadphase and prints the
+    // timings; needs no Init. Returns the process exit code.
+    int Benchmark(int steps);
 
 private:
     SDL_Window* window;
@@ -20,15 +27,29 @@ private:
     bool running;
     
     std::vector<Entity> entities;
-    std::vector<Particle> particles;
     Camera cam;
     int selectedEntity;
 
+    // Simulation runs on its own thread; entities is the editor's copy and
+    // takes body positions from each snapshot it hasn't edited since
+    PhysicsThread physics;
+    PhysicsDebug physicsDebug; // settings sent to the thread, stats read back
+    SceneEdits edits;
+    uint64_t generation;
+    uint64_t replacedAt; // generation of the last wholesale change
+    std::vector<std::pair<int, uint64_t>> inFlight; // in-place edits not yet echoed
+    uint32_t seenStaticMoves;
+    std::vector<uint8_t> held; // per entity, set while an edit is in flight
+    // A click asks the simulation what lies under the cursor
+    PhysicsQueries pickQueries;
+    uint64_t pickQuery; // id of the pick awaiting an answer, or 0
+
     void Update();
+    void SyncPhysics(const PhysicsInput& input);
+    void BuildBenchmarkScene();
     void SaveScene();
     void LoadScene();
     void Undo(); // Ctrl+Z
-    bool CheckCollision(const Entity &a, const Entity &b);
 
     std::vector<std::vector<Entity>> undoStack;
 };
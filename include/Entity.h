@@ -1,9 +1,13 @@
 #ifndef ENTITY_H
 #define ENTITY_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+// Dense index into the renderer's texture table; 0 is always "default"
+using TextureHandle = int;
+
 struct Entity {
     std::string name;
     float x, y;
@@ -15,6 +19,18 @@ struct Entity {
     bool hasGravity;
     bool isStatic;
     float vy;
+    TextureHandle texture = 0; // resolved from textureName at edit/load time
+    int layer = 0;             // draw layer, higher draws on top
+    float prevX = 0, prevY = 0; // position before the last physics step, for interpolation
+    float prevRotation = 0;
+    float vx = 0;               // vy's horizontal partner
+    float angularVelocity = 0;  // radians per second, counter-clockwise
+    float mass = 1;             // of gravity bodies; statics never move
+    float restitution = 0;      // share of an impact's speed it bounces back with
+    // Two entities collide only if each one's mask has a bit of the other's
+    // category; a zero mask keeps an entity out of collision entirely
+    uint16_t collisionCategory = 0x0001; // never zero
+    uint16_t collisionMask = 0xFFFF;
 };
 
 struct Particle {
@@ -0,0 +1,40 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+struct GLStateStats {
+    int issued = 0; // calls that reached the driver
+    int elided = 0; // redundant calls skipped
+};
+
+// Shadows the bits of GL state the renderer changes per draw and drops
+// calls that would set a value that is already current.
+class GLStateCache {
+public:
+    GLStateCache();
+
+    // Forget everything, e.g. after ImGui or another library touched GL
+    void Invalidate();
+    void ResetStats() { stats = GLStateStats(); }
+    const GLStateStats& Stats() const { return stats; }
+
+    void UseProgram(unsigned int program);
+    void BindVertexArray(unsigned int vao);
+    void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+    void SetBlend(bool enabled, unsigned int src, unsigned int dst);
+
+private:
+    static const int kTextureUnits = 4;
+    static const unsigned int kUnknown = ~0u;
+
+    unsigned int program;
+    unsigned int vao;
+    unsigned int activeUnit;
+    unsigned int textures[kTextureUnits];
+    unsigned int textureTargets[kTextureUnits];
+    unsigned int blendEnabled; // kUnknown, 0 or 1
+    unsigned int blendSrc, blendDst;
+
+    GLStateStats stats;
+};
+
+#endif
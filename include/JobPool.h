@@ -0,0 +1,43 @@
+#ifndef JOBPOOL_H
+#define JOBPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. The calling thread
+// works too, so a pool of one thread runs everything inline.
+class JobPool {
+public:
+    JobPool();
+    ~JobPool();
+
+    // Total threads including the caller; 0 picks one per spare core
+    void SetThreads(int threads);
+    int Threads() const { return (int)workers.size() + 1; }
+
+    // Calls fn(index, worker) for every index in [0, count), handing out
+    // runs of `grain` indices; worker is below Threads(). Returns when all
+    // are done.
+    void ParallelFor(int count, int grain, const std::function<void(int, int)>& fn);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(int, int)>* job;
+    int jobCount, jobGrain;
+    unsigned generation; // bumped per loop so workers don't rerun one
+    int busy;            // workers still inside the current loop
+    bool quit;
+    std::atomic<int> next;
+
+    void Stop();
+    void WorkerLoop(int worker, unsigned seen);
+    void RunChunks(int worker);
+};
+
+#endif
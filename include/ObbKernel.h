@@ -0,0 +1,48 @@
+#ifndef OBBKERNEL_H
+#define OBBKERNEL_H
+
+#include <cstdint>
+#include <vector>
+#include "SpatialHash.h"
+
+// Box rotated about its centre; c and s are the cosine and sine of its angle
+struct Obb {
+    float cx, cy;
+    float hx, hy;
+    float c = 1, s = 0;
+
+    static Obb Around(float x, float y, float halfW, float halfH, float rotation);
+    bool IsAxisAligned() const { return s == 0; }
+    // Mirror image across y = x, so X-axis questions can be asked along Y
+    Obb Transposed() const { return IsAxisAligned() ? Obb{cy, cx, hy, hx, 1, 0} : Obb{cy, cx, hx, hy, s, c}; }
+    // Smallest axis-aligned box holding it
+    Aabb Bounds() const;
+    // Counter-clockwise from the local (-hx, -hy) corner
+    void Corners(float xs[4], float ys[4]) const;
+    // Lowest and highest point of the box above world X x; false if x misses it
+    bool SpanAt(float x, float& low, float& high) const;
+};
+
+// Candidate boxes in structure-of-arrays form, padded like AabbSoA
+struct ObbSoA {
+    static const int kBlock = 8;
+
+    std::vector<float> cx, cy, hx, hy, c, s;
+    int count = 0;
+
+    void Clear();
+    void Push(const Obb& box);
+    int Blocks() const { return (int)cx.size() / kBlock; }
+};
+
+// Separating-axis test of one box against every box of an ObbSoA, 8 at a
+// time, on the instruction set AabbKernel::Active() picked
+namespace ObbKernel {
+
+// masks[b] bit i is set when `box` overlaps candidate b * 8 + i
+void OverlapMasks(const Obb& box, const ObbSoA& soa, std::vector<uint8_t>& masks);
+bool AnyOverlap(const Obb& box, const ObbSoA& soa);
+
+} // namespace ObbKernel
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef PHYSICSTHREAD_H
+#define PHYSICSTHREAD_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Entity.h"
+#include "PhysicsWorld.h"
+#include "TripleBuffer.h"
+
+// Editor changes the simulation has to pick up
+struct SceneEdits {
+    bool replaced = false;    // entities added, removed or swapped wholesale
+    std::vector<int> touched; // entities edited in place
+
+    bool Empty() const { return !replaced && touched.empty(); }
+    void Clear() {
+        replaced = false;
+        touched.clear();
+    }
+};
+
+// The part of an entity the simulation writes
+struct BodyState {
+    float x, y, rotation;
+    float vx, vy, angularVelocity;
+    float prevX, prevY, prevRotation;
+};
+
+// Ray, box and point queries to run against the simulation's own scene
+struct PhysicsQueries {
+    QueryFilter filter;
+    std::vector<Ray> rays;
+    std::vector<Aabb> boxes;
+    std::vector<std::pair<float, float>> points;
+};
+
+// Answers to the last PhysicsQueries, in the order they were asked
+struct PhysicsQueryResults {
+    uint64_t id = 0;                       // what SubmitQueries returned; 0 until answered
+    std::vector<RayHit> rayHits;           // one per ray
+    std::vector<int> boxStarts, boxIds;    // box q's entities are boxIds[boxStarts[q] .. boxStarts[q + 1])
+    std::vector<int> pointStarts, pointIds; // likewise per point
+    int candidates = 0;                    // exact tests they took
+};
+
+// Immutable result of one or more physics steps
+struct PhysicsSnapshot {
+    uint64_t generation = 0; // newest editor change folded in
+    std::vector<BodyState> bodies;
+    std::vector<Particle> particles;
+    PhysicsDebug stats;
+    uint64_t stepTime = 0;   // performance counter at the last step
+    uint32_t staticMoves = 0; // bumped whenever a step moved a static entity
+    PhysicsQueryResults queries; // the newest answered queries
+};
+
+// Runs PhysicsWorld on its own thread over a private copy of the scene.
+// The editor keeps the authoritative entity list; every change it makes
+// is submitted with a new generation, and snapshots report which
+// generation they include so stale results never overwrite an edit.
+class PhysicsThread {
+public:
+    PhysicsThread();
+    ~PhysicsThread();
+
+    void Start();
+    void Stop();
+
+    // Main thread: forward edits; copies the entities they touch
+    void Submit(const SceneEdits& edits, const std::vector<Entity>& entities, uint64_t generation);
+    // Main thread: per-frame input and the editor's physics settings
+    void SetControls(const PhysicsInput& input, const PhysicsDebug& settings);
+
+    // Main thread: swaps in the newest snapshot; false if none since last time
+    bool Acquire() { return snapshots.Acquire(); }
+    const PhysicsSnapshot& Latest() const { return snapshots.Front(); }
+
+    // Main thread: queues queries for the end of the next step, replacing
+    // any not yet answered. Their answers come back in the snapshot's
+    // queries once its id matches the returned one.
+    uint64_t SubmitQueries(const PhysicsQueries& queries);
+
+private:
+    struct Pending {
+        uint64_t generation = 0;
+        bool replace = false;
+        std::vector<Entity> scene;                     // when replace
+        std::vector<std::pair<int, Entity>> patches;   // applied after scene
+    };
+
+    std::thread thread;
+    std::atomic<bool> running;
+
+    std::mutex mutex; // guards everything below until the sim-only state
+    Pending pending;
+    PhysicsInput input;
+    PhysicsDebug settings;
+    PhysicsQueries queued;
+    uint64_t queuedId;
+
+    // Simulation thread only
+    PhysicsWorld world;
+    std::vector<Entity> entities;
+    std::vector<Particle> particles;
+    uint64_t generation;
+    uint32_t staticMoves;
+    PhysicsQueries asked;
+    uint64_t askedId;
+    bool unanswered;
+    PhysicsQueryResults answers;
+
+    TripleBuffer<PhysicsSnapshot> snapshots;
+
+    void Run();
+    void Answer();
+    void Publish(uint64_t stepTime);
+};
+
+#endif
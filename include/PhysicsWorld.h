@@ -0,0 +1,261 @@
+#ifndef PHYSICSWORLD_H
+#define PHYSICSWORLD_H
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "AabbKernel.h"
+#include "Broadphase.h"
+#include "ContactCache.h"
+#include "ContactIslands.h"
+#include "Entity.h"
+#include "JobPool.h"
+#include "SceneQuery.h"
+#include "TileMap.h"
+
+// Settings the editor can change plus counters for the last frame
+struct PhysicsDebug {
+    BroadphaseType broadphase = BroadphaseType::SpatialHash;
+    int hz = 60;          // fixed steps per second
+    int maxSubsteps = 5;  // per frame; beyond this, time is dropped
+    bool sleep = true;    // let resting bodies drop out of the step
+    int iterations = 8;   // contact solver passes per step
+    bool warmStart = true; // seed the solver with last step's impulses
+    bool rotation = true; // collide rotated entities as rotated boxes
+    int threads = 0;      // narrowphase and solver threads; 0 = one per spare core
+    bool ccd = true;      // sweep moves longer than the moving box
+    float gravity = 3.6f; // units/s^2, pulling down
+    bool floor = true;    // a static ground below every body
+    float floorY = -0.8f; // its top
+    float floorRestitution = 0.5f; // bounce off the ground; bodies may bounce more
+    float friction = 0.4f; // Coulomb friction at every contact
+    bool tiles = true;    // bake statics into a tile map instead of the broadphase
+    float tileSize = 0.1f; // world units per tile
+    int bodies = 0;
+    int awake = 0, sleeping = 0; // gravity bodies after the last step
+    int steps = 0;        // fixed steps taken this frame
+    int pairTests = 0;    // narrowphase box tests this frame
+    int satTests = 0;     // of those, how many needed the rotated-box test
+    int filtered = 0;     // candidates dropped by collision category/mask
+    float stepMs = 0;     // time spent stepping this frame
+    int contacts = 0;     // manifolds solved in the last step
+    int warmStarted = 0;  // of their points, how many began with an impulse
+    int islands = 0;      // independent groups the solver ran in parallel
+    int sweeps = 0;       // swept moves, for bodies outrunning their own size
+    int sweepHits = 0;    // of those, how many were cut short
+    int threadsUsed = 1;
+    int tileSolid = 0, tileChunks = 0;  // solid tiles and the chunks holding them
+    int tileBaked = 0, tileListed = 0;  // statics baked as solid tiles or listed in tiles
+    float alpha = 1;      // how far rendering is between the last two steps
+    int queryTests = 0;   // exact tests the last answered scene queries took
+
+    void CopySettings(const PhysicsDebug& o) {
+        broadphase = o.broadphase;
+        hz = o.hz;
+        maxSubsteps = o.maxSubsteps;
+        sleep = o.sleep;
+        iterations = o.iterations;
+        warmStart = o.warmStart;
+        rotation = o.rotation;
+        threads = o.threads;
+        ccd = o.ccd;
+        gravity = o.gravity;
+        floor = o.floor;
+        floorY = o.floorY;
+        floorRestitution = o.floorRestitution;
+        friction = o.friction;
+        tiles = o.tiles;
+        tileSize = o.tileSize;
+    }
+    void CopyStats(const PhysicsDebug& o) {
+        bodies = o.bodies;
+        awake = o.awake;
+        sleeping = o.sleeping;
+        steps = o.steps;
+        pairTests = o.pairTests;
+        satTests = o.satTests;
+        filtered = o.filtered;
+        stepMs = o.stepMs;
+        contacts = o.contacts;
+        warmStarted = o.warmStarted;
+        islands = o.islands;
+        sweeps = o.sweeps;
+        sweepHits = o.sweepHits;
+        threadsUsed = o.threadsUsed;
+        tileSolid = o.tileSolid;
+        tileChunks = o.tileChunks;
+        tileBaked = o.tileBaked;
+        tileListed = o.tileListed;
+    }
+};
+
+// Player intent sampled once per frame and applied every fixed step
+struct PhysicsInput {
+    int selected = -1;
+    float moveX = 0, moveY = 0; // -1..1
+    float moveSpeed = 0;        // world units per second
+    bool emit = false;          // spawn particles at the selected entity
+};
+
+// Steps gravity, collisions and particles at a fixed rate, independent of
+// the frame rate. Rendering lerps from prevX/prevY/prevRotation to the
+// current pose by Alpha. Gravity bodies are rigid boxes integrated with
+// semi-implicit Euler; they rest on statics and on each other through a
+// sequential-impulse solver with friction, warm started from cached
+// contacts. Statics can be baked into a tile map, where bodies look up the
+// tiles under them instead of sharing the broadphase with them.
+// Narrowphase and solving are spread over a job pool; each island is
+// solved by one thread in a fixed order, so results don't depend on the
+// thread count.
+class PhysicsWorld {
+public:
+    static constexpr float kSleepSpeed = 0.15f;  // units/s; slower counts as resting
+    static constexpr float kSleepTurn = 0.3f;    // radians/s, likewise
+    static constexpr float kSleepSeconds = 0.5f; // of rest before a body sleeps
+    static constexpr float kWakeMargin = 0.05f;  // reach of a wake around a change
+    static constexpr float kContactMargin = 0.02f; // gap at which contacts start
+    static constexpr float kSlop = 0.005f;         // penetration left alone
+    static constexpr float kBaumgarte = 0.2f;      // share of deeper penetration fixed per step
+    static constexpr float kSkin = 1e-4f;          // gap a swept move stops short by
+    static constexpr float kBounceSpeed = 0.5f;    // units/s; slower impacts don't bounce
+    static constexpr float kFloorDepth = 50.0f;    // half height of the slab standing in for the floor
+
+    PhysicsWorld();
+
+    // Runs the fixed steps frameSeconds covers; returns true if a static
+    // entity was moved and needs rebaking
+    bool Advance(std::vector<Entity>& entities, std::vector<Particle>& particles, const PhysicsInput& input, float frameSeconds);
+    // Makes entities render at their current position, e.g. after an edit
+    static void SnapInterpolation(std::vector<Entity>& entities);
+
+    // Bodies that rest together sleep together, skipping integration and
+    // collision until something changes near any of them, which wakes the
+    // whole group; call these for changes made outside Step
+    void Wake(int entity);
+    void WakeTouching(const std::vector<Entity>& entities, const Aabb& box);
+    // Takes in an entity edited outside Step; a changed entity count is
+    // picked up by the next step on its own
+    void Reload(const std::vector<Entity>& entities, int entity);
+
+    // Drops per-body state and cached contacts, e.g. for a new scene
+    void Reset();
+
+    // Ray, box and point queries over the entities that collide, as of the
+    // last step: bodies and loose statics from the broadphase, the rest
+    // from the tile map. Use between steps, on the thread that steps;
+    // PhysicsThread::SubmitQueries runs them there for other threads.
+    SceneQuery& Query(const std::vector<Entity>& entities);
+
+    // Holds the entity as it collides, rotated unless rotation is off
+    Aabb Bounds(const Entity& e) const;
+
+    PhysicsDebug& Debug() { return debug; }
+    // Seconds of frame time still needed before the next fixed step
+    float UntilNextStep() const { return 1.0f / std::max(debug.hz, 1) - accumulator; }
+
+private:
+    PhysicsDebug debug;
+    float accumulator;
+    std::vector<float> restSeconds; // per entity, its island's; asleep once past kSleepSeconds
+    std::vector<int> sleepRing;     // per entity, the next body of its sleeping island; itself otherwise
+    std::vector<float> islandRest;  // per island this step, the least rest among its bodies
+    std::vector<int> islandFirst;   // per island this step, its first body put to sleep
+
+    // Simulation state per entity, plus a last row standing for the floor
+    // and solid tiles.
+    // Written back to the entities once per step, so integrating and
+    // solving stream packed floats instead of striding over Entity.
+    struct BodyArrays {
+        std::vector<float> x, y, angle;
+        std::vector<float> vx, vy, w;           // linear and angular velocity
+        std::vector<float> invMass, invInertia; // zero unless a gravity body
+        std::vector<float> restitution;
+        std::vector<uint8_t> dynamic;           // a gravity body
+
+        void Resize(size_t n);
+    };
+    BodyArrays bodies;
+    int ground = 0;          // row of the floor and solid tiles: one past the last entity
+    std::vector<int> awake;  // bodies integrated this step, in index order
+    std::vector<int> moved;  // entities given a new pose last step
+    // Bodies whose sweep cut this step's move short, with the velocity each
+    // keeps afterwards: none across whatever it hit
+    struct Cut {
+        int body;
+        float vx, vy;
+    };
+    std::vector<Cut> cuts;
+
+    std::unique_ptr<Broadphase> broadphase;
+    BroadphaseType activeBroadphase;
+    std::vector<Aabb> staticBounds; // per entity, empty unless an active static
+    std::vector<Aabb> bodyBounds;   // what the broadphase holds: statics the tiles don't, plus bodies grown by their reach
+    TileMap tiles;
+    bool tilesDirty = true; // statics changed since the tiles were built
+    int tileSkip = -1;      // the selected entity, kept out of the tiles so it can be steered
+    std::vector<uint8_t> moving;    // per body row, integrated this step
+    std::vector<int> candidates;
+    std::vector<int> candidateIds;
+    std::vector<TileRect> candidateTiles;
+    AabbSoA candidateBounds; // narrowphase input, tested 8 at a time
+    ObbSoA candidateShapes;  // AABB hits that need the rotated test
+    std::vector<uint8_t> masks;
+    ContactCache contacts;
+    ContactIslands islands;
+    // Per entity, the others whose box overlaps its own, kept up to date from
+    // sweep and prune's added and removed pairs while it is the broadphase
+    std::vector<std::vector<int>> overlapping;
+    SceneQuery query;
+
+    // A pair close enough to touch; b == ground means a piece of world
+    // geometry, named by part and given by piece
+    struct ContactPair {
+        int a, b;
+        uint32_t part;
+        Obb piece;
+    };
+    // Per-thread narrowphase state, merged in a fixed order afterwards
+    struct NarrowScratch {
+        AabbSoA bounds;
+        std::vector<int> ids;
+        std::vector<uint8_t> masks;
+        std::vector<int> listed;
+        std::vector<TileRect> solids;
+        std::vector<ContactPair> pairs;
+        int pairTests = 0, filtered = 0, warmStarted = 0;
+    };
+    JobPool pool;
+    std::vector<NarrowScratch> scratch;
+    // Broadphase hits per querying body, gathered on one thread because
+    // queries use the broadphase's own scratch state
+    std::vector<int> queryBodies;
+    std::vector<int> queryStarts;
+    std::vector<int> queryHits;
+
+    bool Step(std::vector<Entity>& entities, std::vector<Particle>& particles, const PhysicsInput& input, float dt);
+    void LoadBody(const Entity& e, int i);
+    void IntegrateVelocities(float dt);
+    void IntegratePositions(const std::vector<Entity>& entities, float dt);
+    bool Asleep(int entity) const { return debug.sleep && restSeconds[entity] >= kSleepSeconds; }
+    static bool IsBody(const Entity& e) { return e.hasGravity && !e.isStatic; }
+    static bool ShouldCollide(const Entity& a, const Entity& b) {
+        return (a.collisionCategory & b.collisionMask) && (b.collisionCategory & a.collisionMask);
+    }
+    // The rotation the entity collides at; 0 when rotation is off
+    float Rotation(const Entity& e) const { return debug.rotation ? e.rotation : 0; }
+    static bool CollidesWithTiles(const Entity& e) {
+        return (e.collisionMask & TileMap::kCategory) && (e.collisionCategory & TileMap::kMask);
+    }
+    Obb Shape(const Entity& e) const;
+    Obb Floor(const Entity& e) const;
+    void BuildBroadphase(const std::vector<Entity>& entities, float dt);
+    void TrackPairs(int count);
+    void FindContacts(std::vector<Entity>& entities, float dt);
+    void NarrowBody(const std::vector<Entity>& entities, int query, float dt, NarrowScratch& out) const;
+    void SolveContacts(float dt);
+    void SolveIsland(Manifold* const* manifolds, int count, float dt, int& warmStarted);
+    bool HitsStatic(const std::vector<Entity>& entities, const Entity& e, int self);
+    float SweepStatics(const std::vector<Entity>& entities, const Entity& e, int self, float dx, float dy, bool& hitX);
+};
+
+#endif
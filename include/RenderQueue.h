@@ -0,0 +1,44 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+enum class BlendMode : uint32_t {
+    Alpha = 0,
+    Additive = 1
+};
+
+struct RenderItem {
+    uint64_t key;
+    uint32_t payload; // caller-defined, e.g. entity or particle index
+};
+
+// Draw items sorted by a packed 64-bit key, most significant first:
+//   layer (8) | blend (2) | shader (4) | texture (20) | depth (30)
+// so state changes happen as rarely as the layering allows.
+class RenderQueue {
+public:
+    static const int kLayerBits = 8;
+    static const int kBlendBits = 2;
+    static const int kShaderBits = 4;
+    static const int kTextureBits = 20;
+    static const int kDepthBits = 30;
+
+    static uint64_t MakeKey(uint32_t layer, BlendMode blend, uint32_t shader, uint32_t texture, uint32_t depth);
+    static uint32_t KeyLayer(uint64_t key) { return (uint32_t)(key >> (64 - kLayerBits)); }
+    static BlendMode KeyBlend(uint64_t key) { return (BlendMode)((key >> (kShaderBits + kTextureBits + kDepthBits)) & ((1u << kBlendBits) - 1)); }
+
+    void Clear() { items.clear(); }
+    void Push(uint64_t key, uint32_t payload) { items.push_back({key, payload}); }
+    // Stable LSD radix sort, 8 bits per pass
+    void Sort();
+
+    const std::vector<RenderItem>& Items() const { return items; }
+
+private:
+    std::vector<RenderItem> items;
+    std::vector<RenderItem> scratch;
+};
+
+#endif
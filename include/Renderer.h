@@ -6,7 +6,34 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include "Entity.h"
+#include "SpriteBatch.h"
+#include "SpriteInstancer.h"
+#include "Shader.h"
+#include "GLState.h"
+#include "TextureAtlas.h"
+#include "TextureArray.h"
+#include "RenderQueue.h"
+#include "AabbTree.h"
+#include "StaticCache.h"
+#include "PhysicsThread.h"
+#include "PhysicsWorld.h"
+#include "AabbKernel.h"
+
+// How entities and particles are submitted to the GPU
+enum class SpritePath {
+    Immediate, // one glDrawElements per sprite
+    Batched,   // CPU-expanded quads in a streamed vertex buffer
+    Instanced  // unit quad + per-instance attributes, transformed on the GPU
+};
+
+// How asset textures are laid out on the GPU
+enum class TexturePacking {
+    Standalone, // one GL texture per image
+    Atlas,      // packed into shared atlas pages
+    Array       // same-size images in texture arrays, odd sizes standalone
+};
 
 // Simple Renderer class to handle OpenGL calls
 class Renderer {
@@ -15,15 +42,33 @@ public:
     ~Renderer();
 
     void Init(SDL_Window* window);
-    void Render(SDL_Window* window, std::vector<Entity>& entities, std::vector<Particle>& particles, const Camera& cam, int& selectedEntityIndex, std::vector<std::vector<Entity>>& undoStack);
+    // Records what the editor changed into edits for the physics thread
+    void Render(SDL_Window* window, std::vector<Entity>& entities, const std::vector<Particle>& particles, const Camera& cam, int& selectedEntityIndex, std::vector<std::vector<Entity>>& undoStack, SceneEdits& edits, PhysicsDebug& physics);
     void RefreshTextures();
 
     // Helpers
     const std::vector<std::string>& GetTextureList() const { return textureList; }
+    // Interns a texture name; call when a name is assigned, never per draw
+    TextureHandle GetTextureHandle(const std::string& name);
+    // Static entities are baked; call when one moves or changes outside the Inspector
+    void MarkStaticDirty(int entity) { staticCache.MarkDirty(entity); }
+    void MarkStaticDirty() { staticCache.MarkAllDirty(); }
+    // The view culling index only refits entities it is told about; call
+    // when an entity's pose changes outside the editor, e.g. from physics
+    void MarkMoved(int entity) { cullMoved.push_back(entity); }
+    void MarkMoved() { cullRebuild = true; }
+    // A click in the scene asks for the entities under a world point; the
+    // engine answers it from the simulation and hands the hits to Pick,
+    // which returns the one drawn on top, or -1
+    bool TakePickRequest(float& x, float& y);
+    int Pick(const std::vector<Entity>& entities, const std::vector<int>& hits) const;
 
 private:
-    unsigned int shaderProgram;
-    unsigned int gridProgram;
+    ShaderProgram spriteShader;
+    ShaderProgram gridShader;
+    ShaderProgram batchShader;
+    ShaderProgram instanceShader;
+    GLStateCache glState;
     unsigned int VAO, VBO, EBO;
     
     // Grid
@@ -32,19 +77,77 @@ private:
     std::vector<float> gridVertices;
 
     // Textures
-    std::map<std::string, unsigned int> textures;
+    std::unordered_map<std::string, TextureHandle> textureHandles; // name -> handle, stable across refreshes
+    std::vector<TextureRegion> textureTable;                       // handle -> region
     std::vector<std::string> textureList;
+    std::vector<unsigned int> ownedTextures; // atlas pages, arrays and standalone textures
+    TextureAtlas atlas;
+    TextureArrayBuilder arrayBuilder;
+    TexturePacking packing = TexturePacking::Atlas;
+    int atlasPages = 0;
+    int textureArrays = 0;
+
+    // Sprite submission
+    static const uint32_t kParticleBit = 0x80000000u; // queue payload flag
+    static const int kParticleLayer = 255;            // particles draw above every entity layer
+    static constexpr float kParticleSize = 0.04f;
+    RenderQueue queue;
+    SpriteBatch batch;
+    SpriteInstancer instancer;
+    SpritePath spritePath = SpritePath::Batched;
+    RenderStats stats;
+    float interpAlpha = 1; // between the previous and current physics step
+    float interpStep = 0;  // seconds per physics step
+
+    // View culling; the tree lives across frames and only refits moved entities
+    AabbTree cullTree;
+    std::vector<int> cullProxies;     // per entity
+    std::vector<Aabb> cullBounds;     // per entity, covering its previous and current position
+    std::vector<uint8_t> cullStatic;  // per entity, as last indexed
+    std::vector<int> cullMoved;       // entities to refit before the next query
+    bool cullRebuild = true;          // entities were added, removed or replaced
+    int cullStatics = 0;
+    std::vector<int> visible;
+    bool cullSprites = true;
+
+    // Click awaiting an answer from the simulation's scene query
+    bool pickRequested = false;
+    float pickX = 0, pickY = 0;
+
+    // Retained static geometry; the immediate path draws statics per sprite
+    StaticCache staticCache;
+    bool cacheStatics = true;
+    bool UseStaticCache() const { return cacheStatics && spritePath != SpritePath::Immediate; }
 
     void InitShader();
     void InitBuffers();
     void InitInfiniteGrid();
-    unsigned int LoadTexture(const char* path);
+    unsigned int CreateTexture(int w, int h, const unsigned char* rgba);
+    const TextureRegion& ResolveTexture(TextureHandle h) const {
+        return (h > 0 && h < (int)textureTable.size()) ? textureTable[h] : textureTable[0];
+    }
     
     // Math helpers
     void CreateTransform(float* m, float x, float y, float r, float sx, float sy);
     void CreateView(float* m, Camera c, float aspect);
-    bool CheckPointInside(Entity& e, float px, float py);
+    static bool BakedFieldsDiffer(const Entity& a, const Entity& b);
+    static bool PhysicsFieldsDiffer(const Entity& a, const Entity& b);
     void SetupUIStyle();
+
+    struct SpriteDesc {
+        const TextureRegion* tex;
+        float x, y, rotation, sx, sy;
+        const float* color;
+        float alpha;
+    };
+    SpriteDesc GetSprite(const RenderItem& item, const std::vector<Entity>& entities, const std::vector<Particle>& particles) const;
+    void ApplyBlend(BlendMode mode);
+    // World-space rectangle shown by CreateView for this camera
+    static Aabb ViewBounds(const Camera& c, float aspect);
+    void IndexForCulling(const std::vector<Entity>& entities, int i);
+    void RefreshCullIndex(const std::vector<Entity>& entities);
+    void CollectVisible(const Aabb& view, const std::vector<Entity>& entities, bool skipStatic);
+    void DrawSprites(const float* vm, const Aabb& view, const std::vector<Entity>& entities, const std::vector<Particle>& particles);
 };
 
 #endif
@@ -0,0 +1,95 @@
+#ifndef SCENEQUERY_H
+#define SCENEQUERY_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Broadphase.h"
+#include "Entity.h"
+#include "JobPool.h"
+#include "ObbKernel.h"
+#include "TileMap.h"
+
+// Which entities a query reports
+struct QueryFilter {
+    uint16_t categories = 0xFFFF; // layer mask: report entities in any of these collision categories
+    int ignore = -1;              // an entity to skip, e.g. the one asking
+
+    bool Accepts(const Entity& e, int id) const { return id != ignore && (e.collisionCategory & categories); }
+};
+
+// Segment from (x, y) to (x + dx, y + dy)
+struct Ray {
+    float x, y, dx, dy;
+};
+
+struct RayHit {
+    int entity = -1;                // -1 when nothing was hit
+    float fraction = 1;             // of the ray travelled before the hit
+    float x = 0, y = 0;             // where the ray enters the entity
+    float normalX = 0, normalY = 0; // of the side it enters through
+};
+
+// Ray, box and point queries against entities as rotated boxes. A
+// broadphase, plus a tile map if statics were baked into one, hands out
+// candidates and the exact test sorts them out. Rays that start inside an
+// entity don't hit it. Batches gather every query's candidates on the
+// calling thread, as broadphases keep query scratch state, then run the
+// exact tests on a job pool when one is bound.
+class SceneQuery {
+public:
+    // Queries run on `index`, whose ids are entity indices and whose boxes
+    // hold their entity at any rotation. Stays valid until either changes.
+    void Bind(const std::vector<Entity>& entities, Broadphase& index, const TileMap* tiles = nullptr, JobPool* pool = nullptr);
+
+    // Nearest entity along the ray; false if none
+    bool RayCast(const Ray& ray, const QueryFilter& filter, RayHit& hit);
+    // Append the entities overlapping box, or with the point inside, in index order
+    void OverlapBox(const Aabb& box, const QueryFilter& filter, std::vector<int>& out);
+    void OverlapPoint(float x, float y, const QueryFilter& filter, std::vector<int>& out);
+
+    // One hit per ray
+    void RayCastBatch(const std::vector<Ray>& rays, const QueryFilter& filter, std::vector<RayHit>& hits);
+    // Query q's entities end up in ids[starts[q] .. starts[q + 1])
+    void OverlapBoxBatch(const std::vector<Aabb>& boxes, const QueryFilter& filter, std::vector<int>& starts, std::vector<int>& ids);
+    void OverlapPointBatch(const std::vector<std::pair<float, float>>& points, const QueryFilter& filter,
+                           std::vector<int>& starts, std::vector<int>& ids);
+
+    int Candidates() const { return (int)candidates.size(); } // exact tests the last batch ran
+
+private:
+    const std::vector<Entity>* entities = nullptr;
+    Broadphase* index = nullptr;
+    const TileMap* tiles = nullptr;
+    JobPool* pool = nullptr;
+
+    std::vector<int> queryStarts; // query q tests candidates[queryStarts[q] .. queryStarts[q + 1])
+    std::vector<int> candidates;
+    std::vector<uint8_t> keep;    // per candidate, passed the exact test
+    std::vector<Obb> queryShapes; // per overlap query
+
+    // Per-thread exact test state
+    struct Scratch {
+        ObbSoA shapes;
+        std::vector<uint8_t> masks;
+    };
+    std::vector<Scratch> scratch;
+
+    // Single queries run as batches of one
+    std::vector<Ray> oneRay;
+    std::vector<RayHit> oneHit;
+    std::vector<Aabb> oneBox;
+    std::vector<std::pair<float, float>> onePoint;
+    std::vector<int> oneStarts, oneIds;
+
+    void BeginBatch();
+    void GatherBox(const Aabb& box, const QueryFilter& filter);
+    void GatherRay(const Ray& ray, const QueryFilter& filter);
+    void EndGather(size_t first, const QueryFilter& filter);
+    // Keeps the candidates overlapping their query's shape and collects them
+    void TestOverlaps(std::vector<int>& starts, std::vector<int>& ids);
+    template <typename F>
+    void ForEachQuery(int count, int grain, const F& fn);
+};
+
+#endif
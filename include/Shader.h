@@ -0,0 +1,36 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+// Uniforms shared by the engine's shaders. Locations are looked up once when
+// the program is linked, never per draw.
+enum class UniformSlot {
+    View,
+    Transform,
+    Tint,
+    Alpha,
+    UvRect,
+    Layer,
+    Texture,
+    TextureArray,
+    Count
+};
+
+class ShaderProgram {
+public:
+    ShaderProgram();
+
+    // Compiles and links; logs and returns false on failure. Samplers are
+    // bound to fixed units: tex -> 0, texArray -> 1.
+    bool Build(const char* vSrc, const char* fSrc);
+
+    unsigned int Id() const { return id; }
+    int Location(UniformSlot slot) const { return locations[(int)slot]; }
+
+private:
+    unsigned int id;
+    int locations[(int)UniformSlot::Count];
+
+    static unsigned int Compile(unsigned int type, const char* src);
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include <cstdint>
+#include <vector>
+#include "Aabb.h"
+
+// Uniform grid over unbounded space. Cells are hashed into a flat bucket
+// table rebuilt with a counting sort, so Build allocates nothing once warm
+// and Query only visits the cells a box touches.
+class SpatialHash {
+public:
+    explicit SpatialHash(float cellSize = 1.0f);
+
+    void SetCellSize(float size);
+    float CellSize() const { return cellSize; }
+
+    // Indexes boxes[i] under id i; empty boxes are skipped
+    void Build(const std::vector<Aabb>& boxes);
+    // Appends the id of every box overlapping `box`, each once
+    void Query(const Aabb& box, std::vector<int>& out);
+
+    int CellsVisited() const { return cellsVisited; }
+
+private:
+    // Boxes spanning more cells than this are kept in a list tested by every query
+    static const int kMaxCellsPerBox = 64;
+
+    struct Cell {
+        int cx, cy, id;
+    };
+
+    float cellSize, invCell;
+    std::vector<Aabb> boxes;
+    std::vector<Cell> cells;           // grouped by bucket
+    std::vector<uint32_t> bucketStart; // bucket b owns cells[bucketStart[b] .. bucketStart[b + 1])
+    uint32_t bucketMask;
+    std::vector<Cell> scratch;
+    std::vector<uint32_t> cursor;
+    std::vector<int> oversized;
+    std::vector<uint32_t> marks;       // per id, == stamp once reported by the current query
+    uint32_t stamp;
+    int cellsVisited;
+
+    int CellCoord(float v) const;
+    uint32_t Bucket(int cx, int cy) const;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <cstdint>
+#include <vector>
+#include "GLState.h"
+#include "StreamBuffer.h"
+#include "TextureAtlas.h"
+
+// Per-frame counters shown in the Render Stats overlay
+struct RenderStats {
+    int drawCalls = 0;
+    int vertices = 0;
+    int sprites = 0;
+    int culled = 0; // entities and particles outside the view
+};
+
+// Quad corner, already transformed to world space
+struct SpriteVertex {
+    float x, y;
+    float u, v;
+    uint32_t color; // RGBA8, alpha in the high byte
+    float layer;    // texture array layer, -1 for 2D textures
+};
+
+// Collects sprites between Begin/End, expands them into one streamed vertex
+// buffer and draws each texture run with a single glDrawElements. Sprites
+// draw in submission order: only adjacent sprites sharing a texture merge,
+// so painter's order is the caller's. The render queue sorts by texture
+// within a layer, which keeps equal textures adjacent.
+class SpriteBatch {
+public:
+    SpriteBatch();
+
+    void Init(int maxSprites);
+    void Begin();
+    void Draw(const TextureRegion& tex, float x, float y, float r, float sx, float sy, const float* color, float alpha);
+    void End(GLStateCache& gl, RenderStats& stats);
+
+    static uint32_t PackColor(const float* color, float alpha);
+    // Writes the four world-space corners of a sprite
+    static void ExpandQuad(const TextureRegion& tex, float x, float y, float r, float sx, float sy, const float* color, float alpha, SpriteVertex* out);
+    // Shared index pattern for `quads` consecutive quads: 0 1 2, 2 3 0
+    static std::vector<unsigned int> QuadIndices(int quads);
+    // Points attributes 0..3 of the bound VAO at SpriteVertex data starting at offset
+    static void SetVertexLayout(size_t offset);
+    // Binds a 2D texture to unit 0 or an array to unit 1, as the shaders expect
+    static void BindTexture(GLStateCache& gl, unsigned int texture, bool array);
+
+    void EndFrame() { stream.EndFrame(); }
+    const StreamBuffer& Stream() const { return stream; }
+
+private:
+    struct Key {
+        unsigned int texture;
+        bool array;
+    };
+
+    unsigned int VAO, EBO;
+    StreamBuffer stream;
+    int capacity;
+
+    std::vector<Key> keys;           // one per sprite
+    std::vector<SpriteVertex> quads; // 4 vertices per sprite, submission order
+
+    void Flush(int first, int count, const Key& key, GLStateCache& gl, RenderStats& stats);
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef STATICCACHE_H
+#define STATICCACHE_H
+
+#include <bitset>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Entity.h"
+#include "GLState.h"
+#include "Aabb.h"
+#include "SpriteBatch.h"
+
+// Bakes isStatic entities into retained vertex buffers, one per world chunk.
+// A chunk is only re-expanded and re-uploaded when one of its entities is
+// marked dirty, so level geometry costs a few draws and no CPU per frame.
+// Draws with the batch shader (SpriteVertex layout).
+class StaticCache {
+public:
+    static constexpr float kChunkSize = 8.0f;
+
+    StaticCache();
+
+    void Init();
+    // The entity at this index changed; its old and new chunks are rebaked
+    void MarkDirty(int entity);
+    // Indices shifted or textures moved; everything is rebaked
+    void MarkAllDirty() { allDirty = true; }
+
+    // Rebakes dirty chunks, clamping layers to maxLayer. A change in entity
+    // count implies MarkAllDirty. Binds GL objects directly.
+    void Update(const std::vector<Entity>& entities, const std::vector<TextureRegion>& textures, int maxLayer);
+    // Picks the chunks overlapping the view; returns static sprites culled
+    int Cull(const Aabb& view);
+    // Lowest layer >= from with culled-in static runs, or INT_MAX
+    int NextLayer(int from) const;
+    // Draws the culled-in runs whose layer is within [firstLayer, lastLayer]
+    void DrawLayers(int firstLayer, int lastLayer, GLStateCache& gl, RenderStats& stats);
+
+    int StaticCount() const { return staticCount; }
+    int ChunkCount() const { return (int)chunks.size(); }
+    int Rebakes() const { return rebakes; }
+
+private:
+    struct Run {
+        int layer;
+        unsigned int texture;
+        bool array;
+        int first, count; // in quads
+    };
+    struct Chunk {
+        std::vector<int> members; // entity indices
+        std::vector<Run> runs;    // sorted by layer, then texture
+        Aabb bounds = {1, 1, 0, 0};
+        unsigned int VAO = 0, VBO = 0;
+        int quadCapacity = 0;
+        bool dirty = true;
+    };
+
+    std::vector<Chunk> chunks;
+    std::unordered_map<uint64_t, int> chunkIndex; // packed cell coords -> chunk
+    std::vector<int> entityChunk;                 // per entity, chunk it is baked into or -1
+    std::vector<int> pending;
+    bool allDirty;
+    unsigned int EBO;
+    int eboQuads;
+    int staticCount;
+    int rebakes;
+    std::vector<int> visibleChunks;
+    std::bitset<256> visibleLayers;
+    std::vector<SpriteVertex> scratch;
+
+    int ChunkFor(const Entity& e);
+    void Bake(Chunk& chunk, const std::vector<Entity>& entities, const std::vector<TextureRegion>& textures, int maxLayer);
+};
+
+#endif
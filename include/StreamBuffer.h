@@ -0,0 +1,48 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <cstddef>
+
+typedef struct __GLsync *GLsync;
+
+// GL_ARRAY_BUFFER that is rewritten every frame. Each Write appends to the
+// buffer and returns the byte offset it landed at, so callers point their
+// attributes there. With GL_ARB_buffer_storage the buffer is a persistently
+// mapped ring split into kFrames segments guarded by fences; otherwise
+// writes go through unsynchronized maps and the storage is orphaned when
+// it fills up. Neither path waits on draws that are still reading.
+class StreamBuffer {
+public:
+    static const int kFrames = 3;
+
+    StreamBuffer();
+
+    // frameBytes is the expected upload per frame; the buffer grows if needed
+    void Init(size_t frameBytes);
+    size_t Write(const void* data, size_t bytes);
+    // Call once after the frame's last draw that reads this buffer
+    void EndFrame();
+
+    unsigned int Id() const { return buffer; }
+    bool IsPersistent() const { return persistent; }
+    // Times the CPU had to block on a fence (persistent path only)
+    int Stalls() const { return stalls; }
+
+private:
+    static const size_t kAlignment = 64;
+
+    unsigned int buffer;
+    bool persistent;
+    unsigned char* mapped;
+    size_t segmentSize; // bytes per frame (persistent) or whole buffer (orphaning)
+    size_t cursor;
+    int frame;
+    bool frameOpen;
+    GLsync fences[kFrames];
+    int stalls;
+
+    void Allocate(size_t bytes);
+    void WaitFence(int index);
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef SWEEPANDPRUNE_H
+#define SWEEPANDPRUNE_H
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+#include "Broadphase.h"
+
+// Sweep and prune on X. Min/max endpoints stay sorted across updates and are
+// re-sorted with insertion sort, which is near O(n) when bodies move a little
+// per step. Each swap of a min past a max starts or ends an X overlap, so the
+// overlap set is maintained incrementally instead of rescanned. PhysicsWorld
+// keeps its contact candidates from the added and removed pairs.
+class SweepAndPruneBroadphase : public Broadphase {
+public:
+    void Update(const std::vector<Aabb>& boxes) override;
+    void Query(const Aabb& box, std::vector<int>& out) override;
+
+    // Overlapping pairs after the last Update, sorted
+    const std::vector<OverlapPair>& Pairs() const { return pairs; }
+    // Changes since the previous Update, sorted
+    const std::vector<OverlapPair>& Added() const { return added; }
+    const std::vector<OverlapPair>& Removed() const { return removed; }
+    int Swaps() const { return swaps; }
+
+private:
+    // Boxes this many times wider than average skip the sweep and are
+    // tested by every query, so one floor does not widen every search
+    static constexpr float kWideFactor = 8.0f;
+
+    struct Endpoint {
+        float value;
+        int id;
+        bool isMin;
+    };
+
+    std::vector<Aabb> boxes;
+    std::vector<char> tracked; // per id, has endpoints
+    std::vector<Endpoint> endpoints;
+    std::unordered_set<uint64_t> xPairs; // overlapping on X only
+    std::vector<OverlapPair> pairs, previous, added, removed;
+    std::vector<char> wide;
+    std::vector<int> wideIds;
+    float maxWidth = 0;
+    int swaps = 0;
+
+    static uint64_t Key(int a, int b);
+    void InsertionSort();
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef TEXTUREARRAY_H
+#define TEXTUREARRAY_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "TextureAtlas.h"
+
+// Loads images that share dimensions into GL_TEXTURE_2D_ARRAYs so sprites
+// with different textures can be drawn in one call without UV bleeding.
+class TextureArrayBuilder {
+public:
+    static const int kMaxLayers = 256; // GL 3.3 guaranteed minimum
+
+    // Groups of at least two same-size images become arrays and get a
+    // region with their layer; everything else is appended to `leftovers`.
+    // Returns the array textures created.
+    std::vector<unsigned int> Build(const std::vector<AtlasImage>& images, std::map<std::string, TextureRegion>& regions, std::vector<AtlasImage>& leftovers);
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Where a named texture lives on the GPU: a GL texture plus the UV rect
+// that covers it (0..1 for standalone textures). Regions with a layer live
+// in a GL_TEXTURE_2D_ARRAY bound to unit 1 instead of a 2D texture on unit 0.
+struct TextureRegion {
+    unsigned int texture = 0;
+    int layer = -1;
+    float u0 = 0, v0 = 0, u1 = 1, v1 = 1;
+
+    bool IsArray() const { return layer >= 0; }
+};
+
+// Decoded RGBA8 image waiting to be packed; pixels are owned by the caller
+struct AtlasImage {
+    std::string name;
+    int w, h;
+    const unsigned char* pixels;
+};
+
+// Bottom-left skyline packer for a single page
+class SkylinePacker {
+public:
+    void Init(int width, int height);
+    bool Insert(int w, int h, int& outX, int& outY);
+
+private:
+    struct Node {
+        int x, y, width;
+    };
+    int pageW, pageH;
+    std::vector<Node> skyline;
+
+    int Fit(size_t index, int w, int h) const;
+};
+
+// Packs images into as few pages as possible and uploads each page as one
+// GL texture, so differently textured sprites share a single bind.
+class TextureAtlas {
+public:
+    static const int kPageSize = 2048;
+    static const int kPadding = 2; // edge texels extruded around every image
+
+    // True if the image (plus padding) fits on an empty page
+    static bool Fits(int w, int h);
+
+    // Packs all images and writes their regions; returns the page textures
+    std::vector<unsigned int> Build(const std::vector<AtlasImage>& images, std::map<std::string, TextureRegion>& regions);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Entity.h"
+#include "SpatialHash.h"
+
+// Solid tiles merged into one box: a run along X, stacked over the rows
+// where the same run repeats. id is unique in the map and stable while the
+// tiles don't change.
+struct TileRect {
+    Aabb box;
+    uint32_t id;
+};
+
+// Static collision baked into a grid of square tiles. Each tile is empty,
+// solid, or lists the statics that touch it without lining up with the
+// grid (rotated or off-grid boxes). Tiles live in 32x32 chunks of solid
+// bits plus per-tile lists, so a body only looks at the tiles under it
+// however many statics the level has.
+class TileMap {
+public:
+    static const int kChunkBits = 5;
+    static const int kChunkTiles = 1 << kChunkBits;
+    // Solid tiles carry the default filter and never bounce; statics that
+    // differ are listed
+    static const uint16_t kCategory = 0x0001;
+    static const uint16_t kMask = 0xFFFF;
+
+    // Bakes every active static in bounds (empty for anything else) except
+    // `skip`. Grid-aligned ones become solid tiles; others are listed unless
+    // they cover more than kMaxListedTiles, which leaves them out.
+    void Build(const std::vector<Entity>& entities, const std::vector<Aabb>& bounds, float tileSize, int skip);
+    void Clear();
+
+    // Whether the entity is in the map, as solid tiles or listed
+    bool Holds(int entity) const { return entity >= 0 && entity < (int)held.size() && held[entity]; }
+    bool Solid(int tx, int ty) const;
+
+    // Appends the rects with a tile under box, each once and whole, so
+    // bodies sliding along a floor or wall meet no seams
+    void Solids(const Aabb& box, std::vector<TileRect>& out) const;
+    // Appends the statics listed in tiles under box, each once
+    void Statics(const Aabb& box, std::vector<int>& out) const;
+    // Appends the statics baked into chunks under box, each once. Chunks
+    // only remember who baked into them, so this is a superset.
+    void Baked(const Aabb& box, std::vector<int>& out) const;
+    // Appends, each once, every static listed or baked in the chunks the
+    // segment from (x, y) to (x + dx, y + dy) crosses
+    void RayStatics(float x, float y, float dx, float dy, std::vector<int>& out) const;
+
+    float TileSize() const { return tileSize; }
+    int SolidTiles() const { return solidTiles; }
+    int ChunkCount() const { return (int)chunks.size(); }
+    int Baked() const { return baked; }
+    int Listed() const { return listed; }
+
+private:
+    static const int kMaxListedTiles = 256;
+
+    // A rect's tiles, inclusive
+    struct TileSpan {
+        int x0, y0, x1, y1;
+    };
+    struct Chunk {
+        uint32_t solid[kChunkTiles] = {}; // bit x of row y
+        std::vector<int> rects;           // into rects, every one with a tile here
+        std::vector<int> starts;          // tile t lists items[starts[t] .. starts[t + 1]); empty if none do
+        std::vector<int> items;
+        std::vector<int> owners;          // statics baked into any of its tiles
+        std::vector<std::pair<int, int>> pending; // (tile, entity) while building
+    };
+
+    float tileSize = 0, invTile = 0;
+    std::unordered_map<uint64_t, Chunk> chunks;
+    std::vector<uint8_t> held;
+    std::vector<TileRect> rects; // merged once per build; id is index + 1
+    std::vector<TileSpan> spans; // per rect
+    int solidTiles = 0, baked = 0, listed = 0;
+
+    int TileCoord(float v) const;
+    static uint64_t ChunkKey(int cx, int cy);
+    const Chunk* Find(int tx, int ty) const;
+    Chunk& At(int tx, int ty);
+    void MergeRects();
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Single-producer single-consumer handoff without locks. The producer fills
+// Back() and publishes it; the consumer picks up the newest published slot
+// with Acquire() and reads Front() until its next Acquire. Neither side ever
+// waits, and intermediate values the consumer was too slow for are dropped.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : back(0), middle(1), front(2) {}
+
+    // Producer side
+    T& Back() { return slots[back]; }
+    void Publish() {
+        back = middle.exchange((uint8_t)(back | kFresh), std::memory_order_acq_rel) & kIndex;
+    }
+
+    // Consumer side; returns false if nothing new was published
+    bool Acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & kFresh)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+    const T& Front() const { return slots[front]; }
+
+private:
+    static const uint8_t kIndex = 0x3;
+    static const uint8_t kFresh = 0x4; // middle holds a slot the consumer hasn't seen
+
+    T slots[3];
+    uint8_t back;
+    std::atomic<uint8_t> middle;
+    uint8_t front;
+};
+
+#endif
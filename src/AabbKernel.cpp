@@ -0,0 +1,153 @@
+#include "AabbKernel.h"
+#include <SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define AABB_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+// GCC/Clang need the target attribute to emit AVX2 in a baseline build;
+// MSVC emits any intrinsic it is given
+#if defined(__GNUC__)
+#define AABB_TARGET(isa) __attribute__((target(isa)))
+#else
+#define AABB_TARGET(isa)
+#endif
+
+void AabbSoA::Clear() {
+    minX.clear();
+    minY.clear();
+    maxX.clear();
+    maxY.clear();
+    count = 0;
+}
+
+void AabbSoA::Push(const Aabb& box) {
+    if (count % kBlock == 0) {
+        // Open a new block of never-overlapping padding
+        minX.resize(minX.size() + kBlock, NAN);
+        minY.resize(minY.size() + kBlock, NAN);
+        maxX.resize(maxX.size() + kBlock, NAN);
+        maxY.resize(maxY.size() + kBlock, NAN);
+    }
+    if (!box.IsEmpty()) {
+        minX[count] = box.minX;
+        minY[count] = box.minY;
+        maxX[count] = box.maxX;
+        maxY[count] = box.maxY;
+    }
+    count++;
+}
+
+namespace {
+
+using MaskFn = void (*)(const Aabb&, const AabbSoA&, uint8_t*);
+
+// Same strict test as Aabb::Overlaps; NaN compares false
+void MasksScalar(const Aabb& box, const AabbSoA& soa, uint8_t* masks) {
+    for (int b = 0; b < soa.Blocks(); b++) {
+        uint8_t m = 0;
+        for (int i = 0; i < AabbSoA::kBlock; i++) {
+            int k = b * AabbSoA::kBlock + i;
+            bool hit = box.minX < soa.maxX[k] && soa.minX[k] < box.maxX && box.minY < soa.maxY[k] && soa.minY[k] < box.maxY;
+            m |= (uint8_t)(hit << i);
+        }
+        masks[b] = m;
+    }
+}
+
+#ifdef AABB_KERNEL_X86
+AABB_TARGET("sse2")
+void MasksSSE(const Aabb& box, const AabbSoA& soa, uint8_t* masks) {
+    __m128 bMinX = _mm_set1_ps(box.minX), bMinY = _mm_set1_ps(box.minY);
+    __m128 bMaxX = _mm_set1_ps(box.maxX), bMaxY = _mm_set1_ps(box.maxY);
+    for (int b = 0; b < soa.Blocks(); b++) {
+        int m = 0;
+        for (int half = 0; half < 2; half++) {
+            int k = b * AabbSoA::kBlock + half * 4;
+            __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(bMinX, _mm_loadu_ps(&soa.maxX[k])),
+                                               _mm_cmplt_ps(_mm_loadu_ps(&soa.minX[k]), bMaxX)),
+                                    _mm_and_ps(_mm_cmplt_ps(bMinY, _mm_loadu_ps(&soa.maxY[k])),
+                                               _mm_cmplt_ps(_mm_loadu_ps(&soa.minY[k]), bMaxY)));
+            m |= _mm_movemask_ps(hit) << (half * 4);
+        }
+        masks[b] = (uint8_t)m;
+    }
+}
+
+AABB_TARGET("avx2")
+void MasksAVX2(const Aabb& box, const AabbSoA& soa, uint8_t* masks) {
+    __m256 bMinX = _mm256_set1_ps(box.minX), bMinY = _mm256_set1_ps(box.minY);
+    __m256 bMaxX = _mm256_set1_ps(box.maxX), bMaxY = _mm256_set1_ps(box.maxY);
+    for (int b = 0; b < soa.Blocks(); b++) {
+        int k = b * AabbSoA::kBlock;
+        __m256 hit = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(bMinX, _mm256_loadu_ps(&soa.maxX[k]), _CMP_LT_OQ),
+                                                 _mm256_cmp_ps(_mm256_loadu_ps(&soa.minX[k]), bMaxX, _CMP_LT_OQ)),
+                                   _mm256_and_ps(_mm256_cmp_ps(bMinY, _mm256_loadu_ps(&soa.maxY[k]), _CMP_LT_OQ),
+                                                 _mm256_cmp_ps(_mm256_loadu_ps(&soa.minY[k]), bMaxY, _CMP_LT_OQ)));
+        masks[b] = (uint8_t)_mm256_movemask_ps(hit);
+    }
+}
+#endif
+
+AabbKernel::Isa Supported() {
+#ifdef AABB_KERNEL_X86
+    if (SDL_HasAVX2()) return AabbKernel::Isa::AVX2;
+    if (SDL_HasSSE2()) return AabbKernel::Isa::SSE;
+#endif
+    return AabbKernel::Isa::Scalar;
+}
+
+// Physics and picking run on different threads; either may bind first
+std::atomic<AabbKernel::Isa> active{AabbKernel::Isa::Scalar};
+std::atomic<MaskFn> kernel{nullptr};
+
+void Bind(AabbKernel::Isa isa) {
+    MaskFn fn = MasksScalar;
+#ifdef AABB_KERNEL_X86
+    if (isa == AabbKernel::Isa::AVX2) fn = MasksAVX2;
+    else if (isa == AabbKernel::Isa::SSE) fn = MasksSSE;
+#endif
+    active = isa;
+    kernel = fn;
+}
+
+} // namespace
+
+namespace AabbKernel {
+
+Isa Active() {
+    if (!kernel) Bind(Supported());
+    return active;
+}
+
+void Select(Isa isa) {
+    Bind(std::min(isa, Supported()));
+}
+
+const char* Name(Isa isa) {
+    switch (isa) {
+    case Isa::AVX2: return "AVX2";
+    case Isa::SSE: return "SSE";
+    default: return "Scalar";
+    }
+}
+
+void OverlapMasks(const Aabb& box, const AabbSoA& soa, std::vector<uint8_t>& masks) {
+    if (!kernel) Bind(Supported());
+    masks.resize(soa.Blocks());
+    if (!masks.empty()) kernel.load()(box, soa, masks.data());
+}
+
+bool AnyOverlap(const Aabb& box, const AabbSoA& soa) {
+    static thread_local std::vector<uint8_t> masks;
+    OverlapMasks(box, soa, masks);
+    for (uint8_t m : masks)
+        if (m) return true;
+    return false;
+}
+
+} // namespace AabbKernel
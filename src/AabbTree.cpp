@@ -0,0 +1,197 @@
+#include "AabbTree.h"
+#include <algorithm>
+
+namespace {
+
+Aabb Union(const Aabb& a, const Aabb& b) {
+    return {std::min(a.minX, b.minX), std::min(a.minY, b.minY), std::max(a.maxX, b.maxX), std::max(a.maxY, b.maxY)};
+}
+
+float Perimeter(const Aabb& a) {
+    return 2.0f * ((a.maxX - a.minX) + (a.maxY - a.minY));
+}
+
+bool Contains(const Aabb& outer, const Aabb& inner) {
+    return outer.minX <= inner.minX && outer.minY <= inner.minY && outer.maxX >= inner.maxX && outer.maxY >= inner.maxY;
+}
+
+Aabb Fatten(const Aabb& a, float margin) {
+    return {a.minX - margin, a.minY - margin, a.maxX + margin, a.maxY + margin};
+}
+
+} // namespace
+
+AabbTree::AabbTree() : root(-1), freeList(-1) {}
+
+void AabbTree::Clear() {
+    nodes.clear();
+    root = -1;
+    freeList = -1;
+}
+
+int AabbTree::AllocateNode() {
+    if (freeList < 0) {
+        nodes.push_back({});
+        freeList = (int)nodes.size() - 1;
+        nodes[freeList].parent = -1;
+    }
+    int n = freeList;
+    freeList = nodes[n].parent;
+    nodes[n].parent = -1;
+    nodes[n].child1 = nodes[n].child2 = -1;
+    nodes[n].height = 0;
+    nodes[n].userId = -1;
+    return n;
+}
+
+void AabbTree::FreeNode(int node) {
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+int AabbTree::CreateProxy(const Aabb& box, int userId) {
+    int leaf = AllocateNode();
+    nodes[leaf].box = Fatten(box, kMargin);
+    nodes[leaf].userId = userId;
+    InsertLeaf(leaf);
+    return leaf;
+}
+
+void AabbTree::DestroyProxy(int proxy) {
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+}
+
+bool AabbTree::MoveProxy(int proxy, const Aabb& box) {
+    // Stay put while inside the fat box, unless the fat box is now far too
+    // big (e.g. the body shrank) and would return needless candidates
+    const Aabb &fat = nodes[proxy].box;
+    if (Contains(fat, box) && Contains(Fatten(box, 4.0f * kMargin), fat)) return false;
+    RemoveLeaf(proxy);
+    nodes[proxy].box = Fatten(box, kMargin);
+    InsertLeaf(proxy);
+    return true;
+}
+
+void AabbTree::Refit(int node) {
+    Node &n = nodes[node];
+    n.height = 1 + std::max(nodes[n.child1].height, nodes[n.child2].height);
+    n.box = Union(nodes[n.child1].box, nodes[n.child2].box);
+}
+
+void AabbTree::InsertLeaf(int leaf) {
+    if (root < 0) {
+        root = leaf;
+        nodes[root].parent = -1;
+        return;
+    }
+
+    // Descend towards the sibling that adds the least perimeter overall
+    Aabb leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].IsLeaf()) {
+        const Node &n = nodes[index];
+        float area = Perimeter(n.box);
+        float combined = Perimeter(Union(n.box, leafBox));
+        // Cost of pairing with this node vs. pushing the leaf further down
+        float cost = 2.0f * combined;
+        float inheritance = 2.0f * (combined - area);
+        auto descendCost = [&](int child) {
+            const Node &c = nodes[child];
+            float grown = Perimeter(Union(leafBox, c.box));
+            return (c.IsLeaf() ? grown : grown - Perimeter(c.box)) + inheritance;
+        };
+        float cost1 = descendCost(n.child1);
+        float cost2 = descendCost(n.child2);
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? n.child1 : n.child2;
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = AllocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = Union(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    if (oldParent < 0) {
+        root = newParent;
+    } else if (nodes[oldParent].child1 == sibling) {
+        nodes[oldParent].child1 = newParent;
+    } else {
+        nodes[oldParent].child2 = newParent;
+    }
+
+    for (int i = nodes[leaf].parent; i >= 0; i = nodes[i].parent) {
+        i = Balance(i);
+        Refit(i);
+    }
+}
+
+void AabbTree::RemoveLeaf(int leaf) {
+    if (leaf == root) {
+        root = -1;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+    FreeNode(parent);
+
+    if (grandParent < 0) {
+        root = sibling;
+        nodes[sibling].parent = -1;
+        return;
+    }
+    if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+    else nodes[grandParent].child2 = sibling;
+    nodes[sibling].parent = grandParent;
+
+    for (int i = grandParent; i >= 0; i = nodes[i].parent) {
+        i = Balance(i);
+        Refit(i);
+    }
+}
+
+// Rotates the taller grandchild up if node's subtrees differ in height by
+// more than one; returns the index now sitting where node was
+int AabbTree::Balance(int iA) {
+    Node &A = nodes[iA];
+    if (A.IsLeaf() || A.height < 2) return iA;
+
+    int iB = A.child1, iC = A.child2;
+    int balance = nodes[iC].height - nodes[iB].height;
+    if (balance >= -1 && balance <= 1) return iA;
+
+    // Promote the taller child (up) and hand its shorter child down to A
+    bool rightHeavy = balance > 1;
+    int iUp = rightHeavy ? iC : iB;
+    int iStay = rightHeavy ? iB : iC;
+    Node &Up = nodes[iUp];
+    int iF = Up.child1, iG = Up.child2;
+
+    Up.child1 = iA;
+    Up.parent = A.parent;
+    A.parent = iUp;
+    if (Up.parent < 0) root = iUp;
+    else if (nodes[Up.parent].child1 == iA) nodes[Up.parent].child1 = iUp;
+    else nodes[Up.parent].child2 = iUp;
+
+    int iKeep = nodes[iF].height > nodes[iG].height ? iF : iG;
+    int iGive = iKeep == iF ? iG : iF;
+    Up.child2 = iKeep;
+    if (rightHeavy) A.child2 = iGive;
+    else A.child1 = iGive;
+    nodes[iGive].parent = iA;
+
+    A.box = Union(nodes[iStay].box, nodes[iGive].box);
+    A.height = 1 + std::max(nodes[iStay].height, nodes[iGive].height);
+    Up.box = Union(A.box, nodes[iKeep].box);
+    Up.height = 1 + std::max(A.height, nodes[iKeep].height);
+    return iUp;
+}
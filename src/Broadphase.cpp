@@ -0,0 +1,71 @@
+#include "Broadphase.h"
+#include <algorithm>
+#include "SweepAndPrune.h"
+
+std::unique_ptr<Broadphase> Broadphase::Create(BroadphaseType type) {
+    switch (type) {
+    case BroadphaseType::BruteForce: return std::make_unique<BruteForceBroadphase>();
+    case BroadphaseType::SpatialHash: return std::make_unique<SpatialHashBroadphase>();
+    case BroadphaseType::AabbTree: return std::make_unique<AabbTreeBroadphase>();
+    case BroadphaseType::SweepAndPrune: return std::make_unique<SweepAndPruneBroadphase>();
+    }
+    return nullptr;
+}
+
+const char* Broadphase::Name(BroadphaseType type) {
+    switch (type) {
+    case BroadphaseType::BruteForce: return "Brute Force";
+    case BroadphaseType::SpatialHash: return "Spatial Hash";
+    case BroadphaseType::AabbTree: return "AABB Tree";
+    case BroadphaseType::SweepAndPrune: return "Sweep and Prune";
+    }
+    return "?";
+}
+
+void Broadphase::RayQuery(float x, float y, float dx, float dy, std::vector<int>& out) {
+    Query({std::min(x, x + dx), std::min(y, y + dy), std::max(x, x + dx), std::max(y, y + dy)}, out);
+}
+
+void BruteForceBroadphase::Update(const std::vector<Aabb>& boxes) {
+    ids.clear();
+    for (int i = 0; i < (int)boxes.size(); i++)
+        if (!boxes[i].IsEmpty()) ids.push_back(i);
+}
+
+// Reports every body so the narrowphase sees the same pairs as before
+void BruteForceBroadphase::Query(const Aabb&, std::vector<int>& out) {
+    out.insert(out.end(), ids.begin(), ids.end());
+}
+
+void AabbTreeBroadphase::Update(const std::vector<Aabb>& boxes) {
+    for (size_t i = boxes.size(); i < proxies.size(); i++)
+        if (proxies[i] >= 0) tree.DestroyProxy(proxies[i]);
+    proxies.resize(boxes.size(), -1);
+    tight.resize(boxes.size());
+
+    for (int i = 0; i < (int)boxes.size(); i++) {
+        const Aabb &b = boxes[i];
+        int &proxy = proxies[i];
+        if (b.IsEmpty()) {
+            if (proxy >= 0) tree.DestroyProxy(proxy);
+            proxy = -1;
+        } else if (proxy < 0) {
+            proxy = tree.CreateProxy(b, i);
+        } else {
+            tree.MoveProxy(proxy, b);
+        }
+        tight[i] = b;
+    }
+}
+
+void AabbTreeBroadphase::Query(const Aabb& box, std::vector<int>& out) {
+    tree.Query(box, [&](int id) {
+        if (tight[id].Overlaps(box)) out.push_back(id);
+    });
+}
+
+void AabbTreeBroadphase::RayQuery(float x, float y, float dx, float dy, std::vector<int>& out) {
+    tree.RayQuery(x, y, dx, dy, [&](int id) {
+        if (tight[id].Crosses(x, y, dx, dy)) out.push_back(id);
+    });
+}
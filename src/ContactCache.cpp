@@ -0,0 +1,131 @@
+#include "ContactCache.h"
+#include <algorithm>
+
+// Points where a faces b across the Y axis: fills out with two, normal is
+// +1 when a is above. Returns 0 when the boxes share no X interval.
+static int FacingY(const Obb& boxA, const Obb& boxB, float& normal, ContactPoint out[2]) {
+    Aabb a = boxA.Bounds(), b = boxB.Bounds();
+    float lo = std::max(a.minX, b.minX);
+    float hi = std::min(a.maxX, b.maxX);
+    if (hi <= lo) return 0;
+
+    // Vertical gap between a's facing outline and b's at x. Both outlines
+    // are straight between corners, so the gap is smallest at an end of the
+    // shared interval or at a corner inside it.
+    // a is above when its span sits higher over the middle of the interval;
+    // comparing centres would flip beside the low end of a slope
+    float aLow = 0, aHigh = 0, bLow = 0, bHigh = 0;
+    boxA.SpanAt((lo + hi) * 0.5f, aLow, aHigh);
+    boxB.SpanAt((lo + hi) * 0.5f, bLow, bHigh);
+    normal = aLow + aHigh >= bLow + bHigh ? 1.0f : -1.0f;
+    auto pointAt = [&](float x, int id) {
+        float aLow = 0, aHigh = 0, bLow = 0, bHigh = 0;
+        boxA.SpanAt(x, aLow, aHigh);
+        boxB.SpanAt(x, bLow, bHigh);
+        ContactPoint p = {};
+        p.x = x;
+        p.y = normal > 0 ? (aLow + bHigh) * 0.5f : (bLow + aHigh) * 0.5f;
+        p.separation = normal > 0 ? aLow - bHigh : bLow - aHigh;
+        p.id = id;
+        return p;
+    };
+
+    // A point is named by the side of the interval it stands for. The end
+    // moves smoothly as the boxes slide, so its impulse carries over even
+    // when the other box's edge takes over as the end.
+    out[0] = pointAt(lo, 0);
+    out[1] = pointAt(hi, 1);
+    if (!boxA.IsAxisAligned() || !boxB.IsAxisAligned()) {
+        // A corner dipping below the end on its half of the interval stands
+        // in for that end; keeping one point per half keeps a wide footing
+        float xs[8], ys[8];
+        boxA.Corners(xs, ys);
+        boxB.Corners(xs + 4, ys + 4);
+        for (int k = 0; k < 8; k++) {
+            if (xs[k] <= lo || xs[k] >= hi) continue;
+            int side = xs[k] - lo < hi - xs[k] ? 0 : 1;
+            ContactPoint p = pointAt(xs[k], side);
+            if (p.separation < out[side].separation) out[side] = p;
+        }
+    }
+    return 2;
+}
+
+void Manifold::Update(const Obb& boxA, const Obb& boxB) {
+    // Facing across X is facing across Y with the axes swapped
+    float ny = 0, nx = 0;
+    ContactPoint next[2], across[2];
+    int countY = FacingY(boxA, boxB, ny, next);
+    int countX = FacingY(boxA.Transposed(), boxB.Transposed(), nx, across);
+    auto depth = [](const ContactPoint* p) { return std::min(p[0].separation, p[1].separation); };
+    if (countX && (!countY || depth(across) > depth(next))) {
+        for (ContactPoint &p : across) std::swap(p.x, p.y);
+        std::copy(across, across + 2, next);
+        ny = 0;
+    } else if (countY) {
+        nx = 0;
+    } else {
+        count = 0;
+        return;
+    }
+
+    // Ids only mean the same edges while the normal stays put
+    if (nx == normalX && ny == normalY) {
+        for (ContactPoint &p : next)
+            for (int k = 0; k < count; k++)
+                if (points[k].id == p.id) {
+                    p.normalImpulse = points[k].normalImpulse;
+                    p.tangentImpulse = points[k].tangentImpulse;
+                }
+    }
+
+    normalX = nx;
+    normalY = ny;
+    points[0] = next[0];
+    points[1] = next[1];
+    count = 2;
+}
+
+// Parts offset b past every entity index, so they never meet another pair
+uint64_t ContactCache::Key(int a, int b, uint32_t part) {
+    return ((uint64_t)(uint32_t)a << 32) | ((uint32_t)b + part);
+}
+
+void ContactCache::Begin() {
+    stamp++;
+    active.clear();
+}
+
+Manifold& ContactCache::Touch(int a, int b, uint32_t part, bool& fresh) {
+    auto it = pairs.find(Key(a, b, part));
+    fresh = it == pairs.end();
+    if (fresh) {
+        it = pairs.emplace(Key(a, b, part), Manifold()).first;
+        it->second.a = a;
+        it->second.b = b;
+        it->second.part = part;
+    }
+    Manifold &m = it->second;
+    if (m.stamp != stamp) {
+        m.stamp = stamp;
+        active.push_back(&m);
+    }
+    return m;
+}
+
+void ContactCache::End() {
+    for (auto it = pairs.begin(); it != pairs.end();) {
+        if (it->second.stamp != stamp) it = pairs.erase(it);
+        else ++it;
+    }
+    std::sort(active.begin(), active.end(),
+              [](const Manifold* x, const Manifold* y) {
+                  if (x->a != y->a) return x->a < y->a;
+                  return x->b != y->b ? x->b < y->b : x->part < y->part;
+              });
+}
+
+void ContactCache::Clear() {
+    pairs.clear();
+    active.clear();
+}
@@ -0,0 +1,49 @@
+#include "ContactIslands.h"
+#include <cstddef>
+
+int ContactIslands::Find(int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]]; // path halving
+        x = parent[x];
+    }
+    return x;
+}
+
+void ContactIslands::Build(int bodyCount, const std::vector<Manifold*>& manifolds, const std::vector<uint8_t>& moving) {
+    parent.resize(bodyCount);
+    label.resize(bodyCount);
+    for (const Manifold *m : manifolds) {
+        parent[m->a] = m->a;
+        parent[m->b] = m->b;
+    }
+    for (const Manifold *m : manifolds) {
+        if (!moving[m->a] || !moving[m->b]) continue;
+        int ra = Find(m->a), rb = Find(m->b);
+        if (ra < rb) parent[rb] = ra;
+        else if (rb < ra) parent[ra] = rb;
+    }
+
+    // Every manifold has a moving body; its root names the island
+    for (const Manifold *m : manifolds) label[Find(moving[m->a] ? m->a : m->b)] = -1;
+    manifoldIsland.resize(manifolds.size());
+    bodyIsland.assign(bodyCount, -1);
+    starts.assign(1, 0);
+    for (size_t i = 0; i < manifolds.size(); i++) {
+        const Manifold *m = manifolds[i];
+        int &id = label[Find(moving[m->a] ? m->a : m->b)];
+        if (id < 0) {
+            id = (int)starts.size() - 1;
+            starts.push_back(0);
+        }
+        manifoldIsland[i] = id;
+        starts[id + 1]++;
+        if (moving[m->a]) bodyIsland[m->a] = id;
+        if (moving[m->b]) bodyIsland[m->b] = id;
+    }
+
+    // Counting sort, stable within each island
+    for (size_t k = 1; k < starts.size(); k++) starts[k] += starts[k - 1];
+    order.resize(manifolds.size());
+    cursor.assign(starts.begin(), starts.end() - 1);
+    for (size_t i = 0; i < manifolds.size(); i++) order[cursor[manifoldIsland[i]]++] = manifolds[i];
+}
@@ -2,12 +2,16 @@
 #include "Input.h"
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
-Engine::Engine() : window(nullptr), running(false), selectedEntity(0) {}
+Engine::Engine() : window(nullptr), running(false), selectedEntity(0), generation(0), replacedAt(0), seenStaticMoves(0), pickQuery(0) {}
 
 Engine::~Engine() {
+    physics.Stop();
     SDL_DestroyWindow(window);
     SDL_Quit();
 }
@@ -22,6 +26,8 @@ void Engine::Init() {
     
     // Attempt to load scene if exists
     LoadScene();
+    edits.replaced = true; // hand the initial scene to the simulation
+    physics.Start();
 }
 
 void Engine::Run() {
@@ -42,7 +48,7 @@ void Engine::Run() {
         }
 
         Update();
-        renderer.Render(window, entities, particles, cam, selectedEntity, undoStack);
+        renderer.Render(window, entities, physics.Latest().particles, cam, selectedEntity, undoStack, edits, physicsDebug);
     }
 }
 
@@ -65,81 +71,124 @@ void Engine::Update() {
         zPressed = false;
     }
 
-    // Entity Control
-    if (selectedEntity >= 0 && selectedEntity < (int)entities.size()) {
-        Entity &e = entities[selectedEntity];
-        float s = 0.02f / cam.zoom;
-        float pdx = 0, pdy = 0;
-
-        if (Input::IsKeyDown(SDL_SCANCODE_W)) pdy += s;
-        if (Input::IsKeyDown(SDL_SCANCODE_S)) pdy -= s;
-        if (Input::IsKeyDown(SDL_SCANCODE_A)) pdx -= s;
-        if (Input::IsKeyDown(SDL_SCANCODE_D)) pdx += s;
-
-        // Try X Movement
-        e.x += pdx;
-        bool collX = false;
-        for (const auto &other : entities) {
-            if (&e == &other || !other.active || !other.isStatic) continue;
-            if (CheckCollision(e, other)) {
-                collX = true;
-                break;
-            }
-        }
-        if (collX) e.x -= pdx; // Revert X
-
-        // Try Y Movement
-        e.y += pdy;
-        bool collY = false;
-        for (const auto &other : entities) {
-            if (&e == &other || !other.active || !other.isStatic) continue;
-            if (CheckCollision(e, other)) {
-                collY = true;
-                break;
-            }
-        }
-        if (collY) e.y -= pdy; // Revert Y
-        
-        if (Input::IsKeyDown(SDL_SCANCODE_SPACE)) {
-            // Spawn Particles
-             for (int k = 0; k < 2; k++)
-                particles.push_back({entities[selectedEntity].x, entities[selectedEntity].y, 
-                                     (float)(rand() % 100 - 50) / 1000, (float)(rand() % 100 - 50) / 1000, 
-                                     1.0f, {1, 0.9f, 0.1f}});
+    // Entity Control, applied by every fixed step
+    PhysicsInput input;
+    input.selected = selectedEntity;
+    input.moveSpeed = 1.2f / cam.zoom;
+    if (Input::IsKeyDown(SDL_SCANCODE_W)) input.moveY += 1;
+    if (Input::IsKeyDown(SDL_SCANCODE_S)) input.moveY -= 1;
+    if (Input::IsKeyDown(SDL_SCANCODE_A)) input.moveX -= 1;
+    if (Input::IsKeyDown(SDL_SCANCODE_D)) input.moveX += 1;
+    input.emit = Input::IsKeyDown(SDL_SCANCODE_SPACE);
+
+    SyncPhysics(input);
+}
+
+// Sends last frame's edits and this frame's input, then adopts the newest
+// snapshot. Bodies with an edit the thread hasn't seen keep the editor's values.
+void Engine::SyncPhysics(const PhysicsInput& input) {
+    if (!edits.Empty()) {
+        generation++;
+        if (edits.replaced) {
+            replacedAt = generation;
+            inFlight.clear();
+        } else {
+            for (int i : edits.touched) inFlight.emplace_back(i, generation);
         }
+        physics.Submit(edits, entities, generation);
+        edits.Clear();
     }
+    physics.SetControls(input, physicsDebug);
 
-    // Physics
-    for (auto &e : entities) {
-        if (e.hasGravity && !e.isStatic) {
-            e.vy -= 0.001f;
-            e.y += e.vy;
-            
-            // Ground Collision
-            for (const auto &other : entities) {
-                if (&e == &other || !other.active || !other.isStatic) continue;
-                if (CheckCollision(e, other)) {
-                    // Simple response: move back and stop
-                    e.y -= e.vy;
-                    e.vy = 0;
-                }
+    float px, py;
+    if (renderer.TakePickRequest(px, py)) {
+        pickQueries.points.assign(1, {px, py});
+        pickQuery = physics.SubmitQueries(pickQueries);
+    }
+
+    bool fresh = physics.Acquire();
+    const PhysicsSnapshot &s = physics.Latest();
+    if (fresh) {
+        physicsDebug.CopyStats(s.stats);
+        physicsDebug.queryTests = s.queries.candidates;
+
+        if (pickQuery && s.queries.id == pickQuery) {
+            // Ids only name our entities if the snapshot has the same scene
+            if (s.generation >= replacedAt && s.bodies.size() == entities.size()) {
+                int hit = renderer.Pick(entities, s.queries.pointIds);
+                if (hit >= 0) selectedEntity = hit;
             }
+            pickQuery = 0;
+        }
 
-            if (e.y < -0.8f) { // Floor default
-                e.y = -0.8f;
-                e.vy *= -0.5f;
+        if (s.generation >= replacedAt && s.bodies.size() == entities.size()) {
+            inFlight.erase(std::remove_if(inFlight.begin(), inFlight.end(),
+                                          [&](const std::pair<int, uint64_t>& p) { return p.second <= s.generation; }),
+                           inFlight.end());
+            held.assign(entities.size(), 0);
+            for (auto &p : inFlight)
+                if (p.first < (int)held.size()) held[p.first] = 1;
+            for (size_t i = 0; i < entities.size(); i++) {
+                if (held[i]) continue;
+                const BodyState &b = s.bodies[i];
+                Entity &e = entities[i];
+                if (e.x != b.x || e.y != b.y || e.prevX != b.prevX || e.prevY != b.prevY) renderer.MarkMoved((int)i);
+                e.x = b.x;
+                e.y = b.y;
+                e.rotation = b.rotation;
+                e.vx = b.vx;
+                e.vy = b.vy;
+                e.angularVelocity = b.angularVelocity;
+                e.prevX = b.prevX;
+                e.prevY = b.prevY;
+                e.prevRotation = b.prevRotation;
+            }
+            if (s.staticMoves != seenStaticMoves) {
+                seenStaticMoves = s.staticMoves;
+                renderer.MarkStaticDirty(selectedEntity);
             }
         }
     }
 
-    // Particles
-    for (auto it = particles.begin(); it != particles.end();) {
-        it->x += it->vx;
-        it->y += it->vy;
-        it->life -= 0.015f;
-        if (it->life <= 0) it = particles.erase(it);
-        else ++it;
+    // Interpolate by how far real time has moved past the snapshot's step
+    float seconds = (float)(SDL_GetPerformanceCounter() - s.stepTime) / (float)SDL_GetPerformanceFrequency();
+    physicsDebug.alpha = s.stepTime ? std::min(seconds * physicsDebug.hz, 1.0f) : 1.0f;
+}
+
+// Static floor with pegs, and a block of falling boxes above it. Fixed, so
+// runs on different builds or broadphases compare like for like.
+void Engine::BuildBenchmarkScene() {
+    entities.clear();
+    for (int i = 0; i < 200; i++)
+        entities.push_back({"Floor", -25.0f + i * 0.25f, -1.0f, 0, 0.25f, 0.25f, {1, 1, 1}, "default", true, false, true, 0});
+    for (int i = 0; i < 100; i++)
+        entities.push_back({"Peg", -24.75f + i * 0.5f, 2.0f + (i % 4) * 0.75f, 0, 0.1f, 0.1f, {1, 1, 1}, "default", true, false, true, 0});
+    for (int row = 0; row < 30; row++)
+        for (int col = 0; col < 80; col++)
+            entities.push_back({"Box", -20.0f + col * 0.5f, 1.0f + row * 0.3f, 0, 0.2f, 0.2f, {1, 1, 1}, "default", true, true, false, 0});
+    PhysicsWorld::SnapInterpolation(entities);
+}
+
+// Exactly one fixed step per Advance, so the step count is what was asked for
+int Engine::Benchmark(int steps) {
+    std::cout << "broadphase, bodies, steps, pair tests/step, ms/step\n";
+    for (BroadphaseType type : kBroadphaseTypes) {
+        BuildBenchmarkScene();
+        std::vector<Particle> particles;
+        PhysicsWorld bench;
+        bench.Debug().broadphase = type;
+        float dt = 1.0f / bench.Debug().hz;
+        long long pairs = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int s = 0; s < steps; s++) {
+            bench.Advance(entities, particles, PhysicsInput(), dt);
+            pairs += bench.Debug().pairTests;
+        }
+        double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+        std::cout << Broadphase::Name(type) << ", " << entities.size() << ", " << steps << ", "
+                  << pairs / steps << ", " << std::fixed << std::setprecision(3) << ms / steps << std::defaultfloat << "\n";
     }
+    return 0;
 }
 
 void Engine::SaveScene() {
@@ -147,7 +196,8 @@ void Engine::SaveScene() {
     for (auto &e : entities) {
         f << e.name << " " << e.x << " " << e.y << " " << e.rotation << " "
           << e.sx << " " << e.sy << " " << e.color[0] << " " << e.color[1] << " " << e.color[2]
-          << " " << e.hasGravity << " " << e.isStatic << " " << e.textureName << "\n";
+          << " " << e.hasGravity << " " << e.isStatic << " " << e.textureName << " " << e.layer
+          << " " << e.collisionCategory << " " << e.collisionMask << " " << e.mass << " " << e.restitution << "\n";
     }
 }
 
@@ -155,29 +205,42 @@ void Engine::LoadScene() {
     std::ifstream f("scene.wary");
     if (!f.is_open()) return;
     entities.clear();
-    char name[64];
-    float x, y, r, sx, sy, c0, c1, c2;
-    int g, st;
-    std::string tName;
-    while (f >> name >> x >> y >> r >> sx >> sy >> c0 >> c1 >> c2 >> g >> st >> tName) {
-        entities.push_back({name, x, y, r, sx, sy, {c0, c1, c2}, tName, true, (bool)g, (bool)st, 0});
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream ls(line);
+        char name[64];
+        float x, y, r, sx, sy, c0, c1, c2;
+        int g, st;
+        std::string tName;
+        if (!(ls >> name >> x >> y >> r >> sx >> sy >> c0 >> c1 >> c2 >> g >> st >> tName)) continue;
+        Entity e = {name, x, y, r, sx, sy, {c0, c1, c2}, tName, true, (bool)g, (bool)st, 0, renderer.GetTextureHandle(tName)};
+        // Optional trailing fields, absent in older scenes
+        int layer, category, mask;
+        if (ls >> layer) e.layer = layer;
+        if (ls >> category >> mask && category != 0) {
+            e.collisionCategory = (uint16_t)category;
+            e.collisionMask = (uint16_t)mask;
+        }
+        float mass, restitution;
+        if (ls >> mass >> restitution && mass > 0) {
+            e.mass = mass;
+            e.restitution = restitution;
+        }
+        entities.push_back(e);
     }
-}
-
-bool Engine::CheckCollision(const Entity &a, const Entity &b) {
-    // Simple AABB
-    float halfAX = a.sx / 2.0f;
-    float halfAY = a.sy / 2.0f;
-    float halfBX = b.sx / 2.0f;
-    float halfBY = b.sy / 2.0f;
-    bool xOverlap = (a.x - halfAX < b.x + halfBX) && (a.x + halfAX > b.x - halfBX);
-    bool yOverlap = (a.y - halfAY < b.y + halfBY) && (a.y + halfAY > b.y - halfBY);
-    return xOverlap && yOverlap;
+    PhysicsWorld::SnapInterpolation(entities);
+    renderer.MarkStaticDirty();
+    edits.replaced = true;
+    renderer.MarkMoved();
 }
 
 void Engine::Undo() {
     if (!undoStack.empty()) {
         entities = undoStack.back();
         undoStack.pop_back();
+        PhysicsWorld::SnapInterpolation(entities);
+        renderer.MarkStaticDirty();
+        edits.replaced = true;
+        renderer.MarkMoved();
     }
 }
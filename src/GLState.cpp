@@ -0,0 +1,78 @@
+#include "GLState.h"
+#include <glad/glad.h>
+
+GLStateCache::GLStateCache() {
+    Invalidate();
+}
+
+void GLStateCache::Invalidate() {
+    program = kUnknown;
+    vao = kUnknown;
+    activeUnit = kUnknown;
+    for (int i = 0; i < kTextureUnits; i++) {
+        textures[i] = kUnknown;
+        textureTargets[i] = kUnknown;
+    }
+    blendEnabled = kUnknown;
+    blendSrc = kUnknown;
+    blendDst = kUnknown;
+}
+
+void GLStateCache::UseProgram(unsigned int p) {
+    if (p == program) {
+        stats.elided++;
+        return;
+    }
+    glUseProgram(p);
+    program = p;
+    stats.issued++;
+}
+
+void GLStateCache::BindVertexArray(unsigned int v) {
+    if (v == vao) {
+        stats.elided++;
+        return;
+    }
+    glBindVertexArray(v);
+    vao = v;
+    stats.issued++;
+}
+
+void GLStateCache::BindTexture(unsigned int unit, unsigned int target, unsigned int texture) {
+    if (unit < kTextureUnits && textures[unit] == texture && textureTargets[unit] == target) {
+        stats.elided++;
+        return;
+    }
+    if (unit != activeUnit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+        stats.issued++;
+    }
+    glBindTexture(target, texture);
+    if (unit < kTextureUnits) {
+        textures[unit] = texture;
+        textureTargets[unit] = target;
+    }
+    stats.issued++;
+}
+
+void GLStateCache::SetBlend(bool enabled, unsigned int src, unsigned int dst) {
+    unsigned int e = enabled ? 1 : 0;
+    if (e != blendEnabled) {
+        if (enabled) glEnable(GL_BLEND);
+        else glDisable(GL_BLEND);
+        blendEnabled = e;
+        stats.issued++;
+    } else {
+        stats.elided++;
+    }
+    if (!enabled) return;
+    if (src != blendSrc || dst != blendDst) {
+        glBlendFunc(src, dst);
+        blendSrc = src;
+        blendDst = dst;
+        stats.issued++;
+    } else {
+        stats.elided++;
+    }
+}
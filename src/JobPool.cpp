@@ -0,0 +1,77 @@
+#include "JobPool.h"
+#include <algorithm>
+
+JobPool::JobPool() : job(nullptr), jobCount(0), jobGrain(1), generation(0), busy(0), quit(false), next(0) {}
+
+JobPool::~JobPool() {
+    Stop();
+}
+
+void JobPool::SetThreads(int threads) {
+    // The caller counts as one; leave a core for the editor's thread
+    if (threads <= 0) threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    if (threads == Threads()) return;
+    Stop();
+    quit = false;
+    for (int w = 1; w < threads; w++) workers.emplace_back(&JobPool::WorkerLoop, this, w, generation);
+}
+
+void JobPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread &t : workers) t.join();
+    workers.clear();
+}
+
+void JobPool::ParallelFor(int count, int grain, const std::function<void(int, int)>& fn) {
+    if (count <= 0) return;
+    grain = std::max(grain, 1);
+    if (workers.empty() || count <= grain) {
+        for (int i = 0; i < count; i++) fn(i, 0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        jobGrain = grain;
+        next = 0;
+        busy = (int)workers.size();
+        generation++;
+    }
+    wake.notify_all();
+    RunChunks(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return busy == 0; });
+    job = nullptr;
+}
+
+void JobPool::RunChunks(int worker) {
+    for (;;) {
+        int begin = next.fetch_add(jobGrain);
+        if (begin >= jobCount) return;
+        int end = std::min(begin + jobGrain, jobCount);
+        for (int i = begin; i < end; i++) (*job)(i, worker);
+    }
+}
+
+// Starts from the generation current at spawn so it never reruns an old loop
+void JobPool::WorkerLoop(int worker, unsigned seen) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+        RunChunks(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busy--;
+        }
+        done.notify_one();
+    }
+}
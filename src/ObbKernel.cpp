@@ -0,0 +1,196 @@
+#include "ObbKernel.h"
+#include "AabbKernel.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define OBB_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define OBB_TARGET(isa) __attribute__((target(isa)))
+#else
+#define OBB_TARGET(isa)
+#endif
+
+Obb Obb::Around(float x, float y, float halfW, float halfH, float rotation) {
+    Obb o = {x, y, halfW, halfH};
+    if (rotation != 0) {
+        o.c = std::cos(rotation);
+        o.s = std::sin(rotation);
+    }
+    return o;
+}
+
+Aabb Obb::Bounds() const {
+    float ex = hx * std::fabs(c) + hy * std::fabs(s);
+    float ey = hx * std::fabs(s) + hy * std::fabs(c);
+    return Aabb::Around(cx, cy, ex, ey);
+}
+
+void Obb::Corners(float xs[4], float ys[4]) const {
+    const float lx[4] = {-hx, hx, hx, -hx};
+    const float ly[4] = {-hy, -hy, hy, hy};
+    for (int i = 0; i < 4; i++) {
+        xs[i] = cx + lx[i] * c - ly[i] * s;
+        ys[i] = cy + lx[i] * s + ly[i] * c;
+    }
+}
+
+bool Obb::SpanAt(float x, float& low, float& high) const {
+    float xs[4], ys[4];
+    Corners(xs, ys);
+    // Bounds() can disagree with the corners in the last bit; pull x in
+    float left = std::min(std::min(xs[0], xs[1]), std::min(xs[2], xs[3]));
+    float right = std::max(std::max(xs[0], xs[1]), std::max(xs[2], xs[3]));
+    if (x < left - 1e-4f || x > right + 1e-4f) return false;
+    x = std::clamp(x, left, right);
+    bool found = false;
+    for (int i = 0; i < 4; i++) {
+        int j = (i + 1) & 3;
+        float x0 = xs[i], x1 = xs[j];
+        if (x < std::min(x0, x1) || x > std::max(x0, x1)) continue;
+        // A vertical edge contributes both ends
+        float ya = x1 == x0 ? ys[i] : ys[i] + (ys[j] - ys[i]) * (x - x0) / (x1 - x0);
+        float yb = x1 == x0 ? ys[j] : ya;
+        if (!found) low = high = ya;
+        low = std::min(low, std::min(ya, yb));
+        high = std::max(high, std::max(ya, yb));
+        found = true;
+    }
+    return found;
+}
+
+void ObbSoA::Clear() {
+    cx.clear();
+    cy.clear();
+    hx.clear();
+    hy.clear();
+    c.clear();
+    s.clear();
+    count = 0;
+}
+
+void ObbSoA::Push(const Obb& box) {
+    if (count % kBlock == 0) {
+        for (std::vector<float> *v : {&cx, &cy, &hx, &hy, &c, &s}) v->resize(v->size() + kBlock, NAN);
+    }
+    cx[count] = box.cx;
+    cy[count] = box.cy;
+    hx[count] = box.hx;
+    hy[count] = box.hy;
+    c[count] = box.c;
+    s[count] = box.s;
+    count++;
+}
+
+namespace {
+
+// Overlapping on all four face axes means overlapping; the compares are
+// written as "inside" so NaN padding always fails. Relative rotation terms:
+// uu = ua.ub = va.vb and uv = ua.vb = -va.ub.
+void MasksScalar(const Obb& a, const ObbSoA& soa, uint8_t* masks) {
+    for (int blk = 0; blk < soa.Blocks(); blk++) {
+        uint8_t m = 0;
+        for (int i = 0; i < ObbSoA::kBlock; i++) {
+            int k = blk * ObbSoA::kBlock + i;
+            float tx = soa.cx[k] - a.cx, ty = soa.cy[k] - a.cy;
+            float bc = soa.c[k], bs = soa.s[k], bhx = soa.hx[k], bhy = soa.hy[k];
+            float uu = std::fabs(a.c * bc + a.s * bs);
+            float uv = std::fabs(a.s * bc - a.c * bs);
+            bool hit = std::fabs(tx * a.c + ty * a.s) < a.hx + bhx * uu + bhy * uv &&
+                       std::fabs(ty * a.c - tx * a.s) < a.hy + bhx * uv + bhy * uu &&
+                       std::fabs(tx * bc + ty * bs) < bhx + a.hx * uu + a.hy * uv &&
+                       std::fabs(ty * bc - tx * bs) < bhy + a.hx * uv + a.hy * uu;
+            m |= (uint8_t)(hit << i);
+        }
+        masks[blk] = m;
+    }
+}
+
+#ifdef OBB_KERNEL_X86
+OBB_TARGET("sse2")
+void MasksSSE(const Obb& a, const ObbSoA& soa, uint8_t* masks) {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 ax = _mm_set1_ps(a.cx), ay = _mm_set1_ps(a.cy), ac = _mm_set1_ps(a.c), as = _mm_set1_ps(a.s);
+    __m128 ahx = _mm_set1_ps(a.hx), ahy = _mm_set1_ps(a.hy);
+    for (int blk = 0; blk < soa.Blocks(); blk++) {
+        int m = 0;
+        for (int half = 0; half < 2; half++) {
+            int k = blk * ObbSoA::kBlock + half * 4;
+            __m128 tx = _mm_sub_ps(_mm_loadu_ps(&soa.cx[k]), ax);
+            __m128 ty = _mm_sub_ps(_mm_loadu_ps(&soa.cy[k]), ay);
+            __m128 bc = _mm_loadu_ps(&soa.c[k]), bs = _mm_loadu_ps(&soa.s[k]);
+            __m128 bhx = _mm_loadu_ps(&soa.hx[k]), bhy = _mm_loadu_ps(&soa.hy[k]);
+            __m128 uu = _mm_andnot_ps(sign, _mm_add_ps(_mm_mul_ps(ac, bc), _mm_mul_ps(as, bs)));
+            __m128 uv = _mm_andnot_ps(sign, _mm_sub_ps(_mm_mul_ps(as, bc), _mm_mul_ps(ac, bs)));
+            __m128 pa = _mm_andnot_ps(sign, _mm_add_ps(_mm_mul_ps(tx, ac), _mm_mul_ps(ty, as)));
+            __m128 pb = _mm_andnot_ps(sign, _mm_sub_ps(_mm_mul_ps(ty, ac), _mm_mul_ps(tx, as)));
+            __m128 pc = _mm_andnot_ps(sign, _mm_add_ps(_mm_mul_ps(tx, bc), _mm_mul_ps(ty, bs)));
+            __m128 pd = _mm_andnot_ps(sign, _mm_sub_ps(_mm_mul_ps(ty, bc), _mm_mul_ps(tx, bs)));
+            __m128 ra = _mm_add_ps(ahx, _mm_add_ps(_mm_mul_ps(bhx, uu), _mm_mul_ps(bhy, uv)));
+            __m128 rb = _mm_add_ps(ahy, _mm_add_ps(_mm_mul_ps(bhx, uv), _mm_mul_ps(bhy, uu)));
+            __m128 rc = _mm_add_ps(bhx, _mm_add_ps(_mm_mul_ps(ahx, uu), _mm_mul_ps(ahy, uv)));
+            __m128 rd = _mm_add_ps(bhy, _mm_add_ps(_mm_mul_ps(ahx, uv), _mm_mul_ps(ahy, uu)));
+            __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(pa, ra), _mm_cmplt_ps(pb, rb)),
+                                    _mm_and_ps(_mm_cmplt_ps(pc, rc), _mm_cmplt_ps(pd, rd)));
+            m |= _mm_movemask_ps(hit) << (half * 4);
+        }
+        masks[blk] = (uint8_t)m;
+    }
+}
+
+OBB_TARGET("avx2")
+void MasksAVX2(const Obb& a, const ObbSoA& soa, uint8_t* masks) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 ax = _mm256_set1_ps(a.cx), ay = _mm256_set1_ps(a.cy), ac = _mm256_set1_ps(a.c), as = _mm256_set1_ps(a.s);
+    __m256 ahx = _mm256_set1_ps(a.hx), ahy = _mm256_set1_ps(a.hy);
+    for (int blk = 0; blk < soa.Blocks(); blk++) {
+        int k = blk * ObbSoA::kBlock;
+        __m256 tx = _mm256_sub_ps(_mm256_loadu_ps(&soa.cx[k]), ax);
+        __m256 ty = _mm256_sub_ps(_mm256_loadu_ps(&soa.cy[k]), ay);
+        __m256 bc = _mm256_loadu_ps(&soa.c[k]), bs = _mm256_loadu_ps(&soa.s[k]);
+        __m256 bhx = _mm256_loadu_ps(&soa.hx[k]), bhy = _mm256_loadu_ps(&soa.hy[k]);
+        __m256 uu = _mm256_andnot_ps(sign, _mm256_add_ps(_mm256_mul_ps(ac, bc), _mm256_mul_ps(as, bs)));
+        __m256 uv = _mm256_andnot_ps(sign, _mm256_sub_ps(_mm256_mul_ps(as, bc), _mm256_mul_ps(ac, bs)));
+        __m256 pa = _mm256_andnot_ps(sign, _mm256_add_ps(_mm256_mul_ps(tx, ac), _mm256_mul_ps(ty, as)));
+        __m256 pb = _mm256_andnot_ps(sign, _mm256_sub_ps(_mm256_mul_ps(ty, ac), _mm256_mul_ps(tx, as)));
+        __m256 pc = _mm256_andnot_ps(sign, _mm256_add_ps(_mm256_mul_ps(tx, bc), _mm256_mul_ps(ty, bs)));
+        __m256 pd = _mm256_andnot_ps(sign, _mm256_sub_ps(_mm256_mul_ps(ty, bc), _mm256_mul_ps(tx, bs)));
+        __m256 ra = _mm256_add_ps(ahx, _mm256_add_ps(_mm256_mul_ps(bhx, uu), _mm256_mul_ps(bhy, uv)));
+        __m256 rb = _mm256_add_ps(ahy, _mm256_add_ps(_mm256_mul_ps(bhx, uv), _mm256_mul_ps(bhy, uu)));
+        __m256 rc = _mm256_add_ps(bhx, _mm256_add_ps(_mm256_mul_ps(ahx, uu), _mm256_mul_ps(ahy, uv)));
+        __m256 rd = _mm256_add_ps(bhy, _mm256_add_ps(_mm256_mul_ps(ahx, uv), _mm256_mul_ps(ahy, uu)));
+        __m256 hit = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(pa, ra, _CMP_LT_OQ), _mm256_cmp_ps(pb, rb, _CMP_LT_OQ)),
+                                   _mm256_and_ps(_mm256_cmp_ps(pc, rc, _CMP_LT_OQ), _mm256_cmp_ps(pd, rd, _CMP_LT_OQ)));
+        masks[blk] = (uint8_t)_mm256_movemask_ps(hit);
+    }
+}
+#endif
+
+} // namespace
+
+namespace ObbKernel {
+
+void OverlapMasks(const Obb& box, const ObbSoA& soa, std::vector<uint8_t>& masks) {
+    masks.resize(soa.Blocks());
+    if (masks.empty()) return;
+    switch (AabbKernel::Active()) {
+#ifdef OBB_KERNEL_X86
+    case AabbKernel::Isa::AVX2: MasksAVX2(box, soa, masks.data()); break;
+    case AabbKernel::Isa::SSE: MasksSSE(box, soa, masks.data()); break;
+#endif
+    default: MasksScalar(box, soa, masks.data()); break;
+    }
+}
+
+bool AnyOverlap(const Obb& box, const ObbSoA& soa) {
+    static thread_local std::vector<uint8_t> masks;
+    OverlapMasks(box, soa, masks);
+    for (uint8_t m : masks)
+        if (m) return true;
+    return false;
+}
+
+} // namespace ObbKernel
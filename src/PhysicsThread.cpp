@@ -0,0 +1,126 @@
+#include "PhysicsThread.h"
+#include <SDL.h>
+
+PhysicsThread::PhysicsThread() : running(false), queuedId(0), generation(0), staticMoves(0), askedId(0), unanswered(false) {}
+
+PhysicsThread::~PhysicsThread() {
+    Stop();
+}
+
+void PhysicsThread::Start() {
+    if (running) return;
+    running = true;
+    thread = std::thread(&PhysicsThread::Run, this);
+}
+
+void PhysicsThread::Stop() {
+    running = false;
+    if (thread.joinable()) thread.join();
+}
+
+void PhysicsThread::Submit(const SceneEdits& edits, const std::vector<Entity>& scene, uint64_t gen) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (edits.replaced) {
+        // Supersedes anything still queued
+        pending.replace = true;
+        pending.scene = scene;
+        pending.patches.clear();
+    } else {
+        for (int i : edits.touched)
+            if (i >= 0 && i < (int)scene.size()) pending.patches.emplace_back(i, scene[i]);
+    }
+    pending.generation = gen;
+}
+
+void PhysicsThread::SetControls(const PhysicsInput& in, const PhysicsDebug& s) {
+    std::lock_guard<std::mutex> lock(mutex);
+    input = in;
+    settings = s;
+}
+
+uint64_t PhysicsThread::SubmitQueries(const PhysicsQueries& queries) {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued = queries;
+    return ++queuedId;
+}
+
+void PhysicsThread::Run() {
+    Uint64 last = SDL_GetPerformanceCounter();
+    while (running) {
+        PhysicsInput in;
+        bool edited = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending.generation != generation) {
+                if (pending.replace) {
+                    entities.swap(pending.scene);
+                    pending.scene.clear();
+                    pending.replace = false;
+                    world.Reset();
+                }
+                for (auto &p : pending.patches) {
+                    if (p.first >= (int)entities.size()) continue;
+                    // Wake whatever rested on the old shape or touches the new one
+                    world.WakeTouching(entities, world.Bounds(entities[p.first]));
+                    entities[p.first] = p.second;
+                    world.Reload(entities, p.first);
+                    world.WakeTouching(entities, world.Bounds(p.second));
+                    world.Wake(p.first);
+                }
+                pending.patches.clear();
+                generation = pending.generation;
+                edited = true;
+            }
+            // The selection always refers to the scene just applied
+            in = input;
+            world.Debug().CopySettings(settings);
+            if (queuedId != askedId) {
+                std::swap(asked, queued);
+                askedId = queuedId;
+                unanswered = true;
+            }
+        }
+
+        Uint64 now = SDL_GetPerformanceCounter();
+        float frameSeconds = (float)(now - last) / (float)SDL_GetPerformanceFrequency();
+        last = now;
+        if (world.Advance(entities, particles, in, frameSeconds)) staticMoves++;
+        // Queries need a step over the current scene to fill the broadphase
+        if (unanswered && world.Debug().steps > 0) Answer();
+        // An edit is echoed straight away so the editor stops holding it back
+        if (world.Debug().steps > 0 || edited) Publish(now);
+
+        // Sleep off the time until the next step is due
+        Uint32 ms = (Uint32)(world.UntilNextStep() * 1000.0f);
+        if (ms > 0) SDL_Delay(ms);
+        else std::this_thread::yield();
+    }
+}
+
+void PhysicsThread::Answer() {
+    SceneQuery &q = world.Query(entities);
+    answers.id = askedId;
+    q.RayCastBatch(asked.rays, asked.filter, answers.rayHits);
+    answers.candidates = q.Candidates();
+    q.OverlapBoxBatch(asked.boxes, asked.filter, answers.boxStarts, answers.boxIds);
+    answers.candidates += q.Candidates();
+    q.OverlapPointBatch(asked.points, asked.filter, answers.pointStarts, answers.pointIds);
+    answers.candidates += q.Candidates();
+    unanswered = false;
+}
+
+void PhysicsThread::Publish(uint64_t stepTime) {
+    PhysicsSnapshot &s = snapshots.Back();
+    s.generation = generation;
+    s.bodies.resize(entities.size());
+    for (size_t i = 0; i < entities.size(); i++) {
+        const Entity &e = entities[i];
+        s.bodies[i] = {e.x, e.y, e.rotation, e.vx, e.vy, e.angularVelocity, e.prevX, e.prevY, e.prevRotation};
+    }
+    s.particles = particles; // reuses the slot's capacity
+    s.stats = world.Debug();
+    s.stepTime = stepTime;
+    s.staticMoves = staticMoves;
+    s.queries = answers;
+    snapshots.Publish();
+}
@@ -0,0 +1,775 @@
+#include "PhysicsWorld.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include "SweepAndPrune.h"
+
+PhysicsWorld::PhysicsWorld() : accumulator(0), activeBroadphase(BroadphaseType::SpatialHash) {}
+
+bool PhysicsWorld::Advance(std::vector<Entity>& entities, std::vector<Particle>& particles, const PhysicsInput& input, float frameSeconds) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    float dt = 1.0f / std::max(debug.hz, 1);
+    pool.SetThreads(debug.threads);
+    scratch.resize(pool.Threads());
+    debug.steps = 0;
+    debug.pairTests = 0;
+    debug.satTests = 0;
+    debug.filtered = 0;
+    debug.sweeps = 0;
+    debug.sweepHits = 0;
+
+    // Never owe more than maxSubsteps; a slow frame drops time instead of
+    // making the next one slower still
+    accumulator = std::min(accumulator + frameSeconds, dt * debug.maxSubsteps);
+    bool movedStatic = false;
+    while (accumulator >= dt) {
+        movedStatic |= Step(entities, particles, input, dt);
+        accumulator -= dt;
+        debug.steps++;
+    }
+
+    debug.alpha = accumulator / dt;
+    debug.bodies = (int)entities.size();
+    debug.stepMs = (float)(SDL_GetPerformanceCounter() - start) * 1000.0f / (float)SDL_GetPerformanceFrequency();
+    return movedStatic;
+}
+
+void PhysicsWorld::SnapInterpolation(std::vector<Entity>& entities) {
+    for (Entity &e : entities) {
+        e.prevX = e.x;
+        e.prevY = e.y;
+        e.prevRotation = e.rotation;
+    }
+}
+
+// Wakes the body and, if it sleeps, the rest of its island with it
+void PhysicsWorld::Wake(int entity) {
+    if (entity < 0 || entity >= (int)restSeconds.size()) return;
+    int i = entity;
+    do {
+        int next = sleepRing[i];
+        restSeconds[i] = 0;
+        sleepRing[i] = i;
+        i = next;
+    } while (i != entity);
+}
+
+void PhysicsWorld::Reset() {
+    restSeconds.clear();
+    sleepRing.clear();
+    bodies.Resize(0);
+    moved.clear();
+    contacts.Clear();
+    tilesDirty = true;
+}
+
+void PhysicsWorld::Reload(const std::vector<Entity>& entities, int entity) {
+    if (entity < 0 || entity >= (int)entities.size()) return;
+    if (bodies.x.size() == entities.size() + 1) LoadBody(entities[entity], entity);
+    if (entities[entity].isStatic || tiles.Holds(entity)) tilesDirty = true;
+}
+
+SceneQuery& PhysicsWorld::Query(const std::vector<Entity>& entities) {
+    if (!broadphase) {
+        broadphase = Broadphase::Create(debug.broadphase);
+        activeBroadphase = debug.broadphase;
+    }
+    query.Bind(entities, *broadphase, &tiles, &pool);
+    return query;
+}
+
+void PhysicsWorld::BodyArrays::Resize(size_t n) {
+    for (std::vector<float> *v : {&x, &y, &angle, &vx, &vy, &w, &invMass, &invInertia, &restitution}) v->assign(n, 0.0f);
+    dynamic.assign(n, 0);
+}
+
+void PhysicsWorld::LoadBody(const Entity& e, int i) {
+    bodies.x[i] = e.x;
+    bodies.y[i] = e.y;
+    bodies.angle[i] = e.rotation;
+    bodies.vx[i] = e.vx;
+    bodies.vy[i] = e.vy;
+    bodies.w[i] = e.angularVelocity;
+    bool body = IsBody(e);
+    bodies.dynamic[i] = body;
+    bodies.restitution[i] = e.restitution;
+    // A solid box: I = m (w^2 + h^2) / 12
+    float mass = std::max(e.mass, 1e-3f);
+    float spread = e.sx * e.sx + e.sy * e.sy;
+    bodies.invMass[i] = body ? 1.0f / mass : 0;
+    bodies.invInertia[i] = body && spread > 0 ? 12.0f / (mass * spread) : 0;
+}
+
+// Wakes every body near box, e.g. ones resting on a static that just moved
+void PhysicsWorld::WakeTouching(const std::vector<Entity>& entities, const Aabb& box) {
+    Aabb reach = {box.minX - kWakeMargin, box.minY - kWakeMargin, box.maxX + kWakeMargin, box.maxY + kWakeMargin};
+    for (int i = 0; i < (int)restSeconds.size() && i < (int)entities.size(); i++)
+        if (restSeconds[i] > 0 && Bounds(entities[i]).Overlaps(reach)) Wake(i);
+}
+
+bool PhysicsWorld::Step(std::vector<Entity>& entities, std::vector<Particle>& particles, const PhysicsInput& input, float dt) {
+    bool movedStatic = false;
+    int n = (int)entities.size();
+    if (restSeconds.size() != entities.size()) {
+        restSeconds.assign(n, 0.0f);
+        sleepRing.resize(n);
+        std::iota(sleepRing.begin(), sleepRing.end(), 0);
+    }
+    if (bodies.x.size() != entities.size() + 1) {
+        bodies.Resize(n + 1);
+        for (int i = 0; i < n; i++) LoadBody(entities[i], i);
+        moved.clear();
+        tilesDirty = true;
+    }
+    // A static being steered leaves the tiles while it is selected
+    if (input.selected != tileSkip) {
+        auto isStatic = [&](int i) { return i >= 0 && i < n && entities[i].isStatic; };
+        if (isStatic(input.selected) || isStatic(tileSkip)) tilesDirty = true;
+        tileSkip = input.selected;
+    }
+    ground = n;
+    bodies.restitution[ground] = debug.floorRestitution;
+
+    // Whatever moved last step renders where it is unless it moves again
+    for (int i : moved) {
+        Entity &e = entities[i];
+        e.prevX = e.x;
+        e.prevY = e.y;
+        e.prevRotation = e.rotation;
+    }
+    moved.clear();
+
+    // Sleeping islands hold still; anything that reaches one wakes it for
+    // the next step
+    moving.assign(n + 1, 0);
+    awake.clear();
+    debug.sleeping = 0;
+    for (int i = 0; i < n; i++) {
+        if (!bodies.dynamic[i]) continue;
+        if (Asleep(i)) {
+            debug.sleeping++;
+            continue;
+        }
+        moving[i] = 1;
+        awake.push_back(i);
+    }
+    debug.awake = (int)awake.size();
+    IntegrateVelocities(dt);
+    BuildBroadphase(entities, dt);
+
+    // Entity Control
+    int steered = -1;
+    if (input.selected >= 0 && input.selected < n) {
+        Entity &e = entities[input.selected];
+        float pdx = input.moveX * input.moveSpeed * dt;
+        float pdy = input.moveY * input.moveSpeed * dt;
+        Aabb from = Bounds(e);
+        float fromX = e.x, fromY = e.y;
+
+        // Try X Movement; one longer than the box could skip a thin wall
+        // between its start and end, so it stops at the first one instead
+        bool hitX;
+        if (debug.ccd && std::fabs(pdx) > from.maxX - from.minX) pdx *= SweepStatics(entities, e, input.selected, pdx, 0, hitX);
+        e.x += pdx;
+        if (HitsStatic(entities, e, input.selected)) e.x -= pdx; // Revert X
+
+        // Try Y Movement
+        Aabb mid = Bounds(e);
+        if (debug.ccd && std::fabs(pdy) > mid.maxY - mid.minY) pdy *= SweepStatics(entities, e, input.selected, 0, pdy, hitX);
+        e.y += pdy;
+        if (HitsStatic(entities, e, input.selected)) e.y -= pdy; // Revert Y
+        if (pdx != 0 || pdy != 0) {
+            steered = input.selected;
+            e.prevX = fromX;
+            e.prevY = fromY;
+            e.prevRotation = e.rotation;
+            moved.push_back(steered);
+            bodies.x[steered] = e.x;
+            bodies.y[steered] = e.y;
+            Wake(input.selected);
+            BuildBroadphase(entities, dt); // contacts below must see where it went
+            if (e.isStatic) {
+                movedStatic = true;
+                WakeTouching(entities, from);
+                WakeTouching(entities, Bounds(e));
+            }
+        }
+
+        if (input.emit) {
+            // Spawn Particles, up to 3 units/s in any direction
+            for (int k = 0; k < 2; k++)
+                particles.push_back({e.x, e.y, (float)(rand() % 100 - 50) * 0.06f, (float)(rand() % 100 - 50) * 0.06f,
+                                     1.0f, {1, 0.9f, 0.1f}});
+        }
+    }
+
+    FindContacts(entities, dt);
+    SolveContacts(dt);
+    IntegratePositions(entities, dt);
+
+    // Hand the new poses back; a steered body keeps the start of its move
+    for (int i : awake) {
+        Entity &e = entities[i];
+        if (i != steered) {
+            e.prevX = e.x;
+            e.prevY = e.y;
+            e.prevRotation = e.rotation;
+        }
+        e.x = bodies.x[i];
+        e.y = bodies.y[i];
+        e.rotation = bodies.angle[i];
+        e.vx = bodies.vx[i];
+        e.vy = bodies.vy[i];
+        e.angularVelocity = bodies.w[i];
+        moved.push_back(i);
+    }
+
+    // Particles
+    for (auto it = particles.begin(); it != particles.end();) {
+        it->x += it->vx * dt;
+        it->y += it->vy * dt;
+        it->life -= 0.9f * dt;
+        if (it->life <= 0) it = particles.erase(it);
+        else ++it;
+    }
+    return movedStatic;
+}
+
+// Gravity over every row at once; rows not moving get a zero step, which
+// keeps the loop free of branches
+void PhysicsWorld::IntegrateVelocities(float dt) {
+    float pull = debug.gravity * dt;
+    float *vy = bodies.vy.data();
+    const uint8_t *m = moving.data();
+    for (int i = 0; i <= ground; i++) vy[i] -= pull * (float)m[i];
+}
+
+// Semi-implicit Euler: positions move by the velocities the solver just
+// produced. Bodies that would outrun their own size are swept against the
+// statics first, as contacts only cover what the broadphase saw.
+void PhysicsWorld::IntegratePositions(const std::vector<Entity>& entities, float dt) {
+    cuts.clear();
+    if (debug.ccd) {
+        for (int i : awake) {
+            const Entity &e = entities[i];
+            float dx = bodies.vx[i] * dt, dy = bodies.vy[i] * dt;
+            Aabb box = Bounds(e);
+            if (!e.active || (std::fabs(dx) <= box.maxX - box.minX && std::fabs(dy) <= box.maxY - box.minY)) continue;
+            bool hitX;
+            float t = SweepStatics(entities, e, i, dx, dy, hitX);
+            if (t >= 1) continue;
+
+            // Only the blocked axis stops at the hit. The rest of the step
+            // slides along the surface, swept again from where it touched.
+            Entity at = e;
+            at.x += dx * t;
+            at.y += dy * t;
+            float slide = (1 - t) * (hitX ? dy : dx);
+            bool slideHitX;
+            float s = slide != 0 ? SweepStatics(entities, at, i, hitX ? 0 : slide, hitX ? slide : 0, slideHitX) : 1;
+            Cut cut = {i, bodies.vx[i], bodies.vy[i]};
+            (hitX ? cut.vx : cut.vy) = 0;
+            if (s < 1) (hitX ? cut.vy : cut.vx) = 0;
+            float along = t + (1 - t) * s;
+            bodies.vx[i] *= hitX ? t : along;
+            bodies.vy[i] *= hitX ? along : t;
+            cuts.push_back(cut);
+        }
+    }
+
+    float *x = bodies.x.data(), *y = bodies.y.data(), *angle = bodies.angle.data();
+    const float *vx = bodies.vx.data(), *vy = bodies.vy.data(), *w = bodies.w.data();
+    const uint8_t *m = moving.data();
+    float spin = debug.rotation ? dt : 0;
+    for (int i = 0; i <= ground; i++) {
+        float step = dt * (float)m[i];
+        x[i] += vx[i] * step;
+        y[i] += vy[i] * step;
+        angle[i] += w[i] * spin * (float)m[i];
+    }
+    for (const Cut &c : cuts) {
+        bodies.vx[c.body] = c.vx;
+        bodies.vy[c.body] = c.vy;
+    }
+
+    // An island has rested as long as its least rested body. Once that is
+    // long enough all of it sleeps with no leftover speed, linked in a ring
+    // so waking any of its bodies wakes the rest.
+    islandRest.assign(islands.Count(), INFINITY);
+    islandFirst.assign(islands.Count(), -1);
+    for (int i : awake) {
+        float speed2 = bodies.vx[i] * bodies.vx[i] + bodies.vy[i] * bodies.vy[i];
+        bool resting = speed2 < kSleepSpeed * kSleepSpeed && std::fabs(bodies.w[i]) < kSleepTurn;
+        restSeconds[i] = resting ? restSeconds[i] + dt : 0;
+        int id = islands.IslandOf(i);
+        if (id >= 0) islandRest[id] = std::min(islandRest[id], restSeconds[i]);
+    }
+    for (int i : awake) {
+        int id = islands.IslandOf(i);
+        if (id >= 0) restSeconds[i] = islandRest[id];
+        sleepRing[i] = i;
+        if (!Asleep(i)) continue;
+        bodies.vx[i] = bodies.vy[i] = bodies.w[i] = 0;
+        if (id < 0) continue;
+        int &first = islandFirst[id];
+        if (first < 0) {
+            first = i;
+        } else {
+            sleepRing[i] = sleepRing[first];
+            sleepRing[first] = i;
+        }
+    }
+}
+
+// Indexes active statics as they are and active bodies grown by how far
+// they can travel or turn this step, so contacts are found before impact.
+// Entities that collide with nothing are left out altogether, and statics
+// the tile map holds are looked up there instead.
+void PhysicsWorld::BuildBroadphase(const std::vector<Entity>& entities, float dt) {
+    if (!broadphase || debug.broadphase != activeBroadphase) {
+        broadphase = Broadphase::Create(debug.broadphase);
+        activeBroadphase = debug.broadphase;
+        overlapping.clear();
+    }
+    staticBounds.resize(entities.size());
+    bodyBounds.resize(entities.size());
+    for (size_t i = 0; i < entities.size(); i++) {
+        const Entity &o = entities[i];
+        bool collides = o.active && o.collisionMask != 0;
+        staticBounds[i] = (collides && o.isStatic) ? Bounds(o) : Aabb{1, 1, 0, 0};
+        bodyBounds[i] = staticBounds[i];
+        if (collides && IsBody(o)) {
+            float reachX = kContactMargin, reachY = kContactMargin;
+            if (moving[i]) {
+                // A corner turning at w sweeps at most w times the half diagonal
+                float turn = debug.rotation ? std::fabs(bodies.w[i]) * dt * 0.5f * std::sqrt(o.sx * o.sx + o.sy * o.sy) : 0;
+                reachX += std::fabs(bodies.vx[i]) * dt + turn;
+                reachY += std::fabs(bodies.vy[i]) * dt + turn;
+            }
+            bodyBounds[i] = Bounds(o);
+            bodyBounds[i].minX -= reachX;
+            bodyBounds[i].maxX += reachX;
+            bodyBounds[i].minY -= reachY;
+            bodyBounds[i].maxY += reachY;
+        }
+    }
+
+    if (!debug.tiles) {
+        tiles.Clear();
+        tilesDirty = true;
+    } else if (tilesDirty || tiles.TileSize() != debug.tileSize) {
+        tiles.Build(entities, staticBounds, std::max(debug.tileSize, 0.01f), tileSkip);
+        tilesDirty = false;
+    }
+    for (size_t i = 0; i < entities.size(); i++)
+        if (tiles.Holds((int)i)) bodyBounds[i] = Aabb{1, 1, 0, 0};
+    debug.tileSolid = tiles.SolidTiles();
+    debug.tileChunks = tiles.ChunkCount();
+    debug.tileBaked = tiles.Baked();
+    debug.tileListed = tiles.Listed();
+    broadphase->Update(bodyBounds);
+    if (activeBroadphase == BroadphaseType::SweepAndPrune) TrackPairs((int)entities.size());
+}
+
+// Applies the pairs sweep and prune started and ended this update. A fresh
+// broadphase reports every pair as added, so this also fills the lists.
+void PhysicsWorld::TrackPairs(int count) {
+    const SweepAndPruneBroadphase &sap = static_cast<const SweepAndPruneBroadphase&>(*broadphase);
+    overlapping.resize(std::max((int)overlapping.size(), count));
+    for (const OverlapPair &p : sap.Removed()) {
+        for (auto [from, to] : {std::pair{p.a, p.b}, std::pair{p.b, p.a}}) {
+            std::vector<int> &list = overlapping[from];
+            auto it = std::find(list.begin(), list.end(), to);
+            if (it == list.end()) continue; // never added, e.g. dropped with a removed entity
+            *it = list.back();
+            list.pop_back();
+        }
+    }
+    for (const OverlapPair &p : sap.Added()) {
+        overlapping[p.a].push_back(p.b);
+        overlapping[p.b].push_back(p.a);
+    }
+    overlapping.resize(count);
+}
+
+// A solid tile rect as a box the manifolds can take
+static Obb TileShape(const Aabb& box) {
+    return Obb::Around((box.minX + box.maxX) * 0.5f, (box.minY + box.maxY) * 0.5f, (box.maxX - box.minX) * 0.5f, (box.maxY - box.minY) * 0.5f, 0);
+}
+
+// Refreshes the cached manifold of every moving body and whatever it could
+// reach this step. A pair of moving bodies is found from its lower index.
+// Sweep and prune already knows each body's overlaps, so it skips the query.
+void PhysicsWorld::FindContacts(std::vector<Entity>& entities, float dt) {
+    bool tracked = activeBroadphase == BroadphaseType::SweepAndPrune;
+    queryBodies.clear();
+    queryStarts.assign(1, 0);
+    queryHits.clear();
+    for (int i : awake) {
+        if (!entities[i].active || entities[i].collisionMask == 0) continue;
+        queryBodies.push_back(i);
+        if (tracked) queryHits.insert(queryHits.end(), overlapping[i].begin(), overlapping[i].end());
+        else broadphase->Query(bodyBounds[i], queryHits);
+        queryStarts.push_back((int)queryHits.size());
+    }
+
+    for (NarrowScratch &s : scratch) {
+        s.pairs.clear();
+        s.pairTests = s.filtered = 0;
+    }
+    pool.ParallelFor((int)queryBodies.size(), 16, [&](int n, int worker) { NarrowBody(entities, n, dt, scratch[worker]); });
+
+    contacts.Begin();
+    for (NarrowScratch &s : scratch) {
+        debug.pairTests += s.pairTests;
+        debug.filtered += s.filtered;
+        for (const ContactPair &p : s.pairs) {
+            bool fresh;
+            contacts.Touch(p.a, p.b, p.part, fresh).piece = p.piece;
+            // Something touching a sleeping body wakes its island for the next step
+            if (!moving[p.b] && bodies.dynamic[p.b]) Wake(p.b);
+        }
+    }
+    contacts.End();
+
+    std::vector<Manifold*> &active = contacts.Active();
+    pool.ParallelFor((int)active.size(), 64, [&](int n, int) {
+        Manifold &m = *active[n];
+        const Entity &a = entities[m.a];
+        m.Update(Shape(a), m.b == ground ? m.piece : Shape(entities[m.b]));
+    });
+}
+
+// Filters one body's broadphase hits and the statics listed in the tiles
+// under it down to the pairs close enough to touch this step, then adds
+// the solid tile rects and the floor when they are that close
+void PhysicsWorld::NarrowBody(const std::vector<Entity>& entities, int query, float dt, NarrowScratch& out) const {
+    int i = queryBodies[query];
+    out.bounds.Clear();
+    out.ids.clear();
+    for (int h = queryStarts[query]; h < queryStarts[query + 1]; h++) {
+        int k = queryHits[h];
+        if (k == i || (moving[k] && k < i)) continue;
+        if (!ShouldCollide(entities[i], entities[k])) {
+            out.filtered++;
+            continue;
+        }
+        out.bounds.Push(bodyBounds[k]);
+        out.ids.push_back(k);
+    }
+    out.listed.clear();
+    tiles.Statics(bodyBounds[i], out.listed);
+    for (int k : out.listed) {
+        if (!ShouldCollide(entities[i], entities[k])) {
+            out.filtered++;
+            continue;
+        }
+        out.bounds.Push(staticBounds[k]);
+        out.ids.push_back(k);
+    }
+    out.pairTests += out.bounds.count;
+    AabbKernel::OverlapMasks(bodyBounds[i], out.bounds, out.masks);
+
+    // The grown bounds overlapping says each could reach the other; the
+    // exact boxes say whether the gap is small enough on both axes
+    Aabb boxA = Bounds(entities[i]);
+    float reachX = kContactMargin + std::fabs(bodies.vx[i]) * dt;
+    float reachY = kContactMargin + std::fabs(bodies.vy[i]) * dt;
+    for (int h = 0; h < out.bounds.count; h++) {
+        if (!((out.masks[h / AabbSoA::kBlock] >> (h % AabbSoA::kBlock)) & 1)) continue;
+        int k = out.ids[h];
+        Aabb boxB = Bounds(entities[k]);
+        float gapX = std::max(boxA.minX - boxB.maxX, boxB.minX - boxA.maxX);
+        float gapY = std::max(boxA.minY - boxB.maxY, boxB.minY - boxA.maxY);
+        float moveX = moving[k] ? std::fabs(bodies.vx[k]) * dt : 0;
+        float moveY = moving[k] ? std::fabs(bodies.vy[k]) * dt : 0;
+        if (gapX <= reachX + moveX && gapY <= reachY + moveY) out.pairs.push_back({i, k, 0, Obb{}});
+    }
+
+    out.solids.clear();
+    if (CollidesWithTiles(entities[i])) tiles.Solids(bodyBounds[i], out.solids);
+    out.pairTests += (int)out.solids.size();
+    for (const TileRect &t : out.solids) {
+        float gapX = std::max(boxA.minX - t.box.maxX, t.box.minX - boxA.maxX);
+        float gapY = std::max(boxA.minY - t.box.maxY, t.box.minY - boxA.maxY);
+        if (gapX <= reachX && gapY <= reachY) out.pairs.push_back({i, ground, t.id, TileShape(t.box)});
+    }
+    if (debug.floor && bodyBounds[i].minY <= debug.floorY) out.pairs.push_back({i, ground, 0, Floor(entities[i])});
+}
+
+void PhysicsWorld::SolveContacts(float dt) {
+    std::vector<Manifold*> &active = contacts.Active();
+    islands.Build(ground + 1, active, moving);
+    debug.contacts = (int)active.size();
+    debug.islands = islands.Count();
+    debug.threadsUsed = pool.Threads();
+
+    for (NarrowScratch &s : scratch) s.warmStarted = 0;
+    pool.ParallelFor(islands.Count(), 1, [&](int n, int worker) {
+        SolveIsland(islands.Begin(n), islands.Size(n), dt, scratch[worker].warmStarted);
+    });
+    debug.warmStarted = 0;
+    for (NarrowScratch &s : scratch) debug.warmStarted += s.warmStarted;
+}
+
+// Both normal impulses at once: the pair (x1, x2) >= 0 that leaves neither
+// point approaching faster than its target, found by trying which points
+// push, in the order Box2D's block solver does
+template <typename Relative, typename Apply>
+static void SolveBlock(Manifold& m, const Relative& relative, const Apply& apply) {
+    ContactPoint &p1 = m.points[0], &p2 = m.points[1];
+    float dx, dy;
+    relative(m, p1, dx, dy);
+    float vn1 = dx * m.normalX + dy * m.normalY;
+    relative(m, p2, dx, dy);
+    float vn2 = dx * m.normalX + dy * m.normalY;
+
+    // Speeds with the current impulses taken back out
+    float a1 = p1.normalImpulse, a2 = p2.normalImpulse;
+    float b1 = vn1 - p1.targetSpeed - (m.k11 * a1 + m.k12 * a2);
+    float b2 = vn2 - p2.targetSpeed - (m.k12 * a1 + m.k22 * a2);
+
+    float det = m.k11 * m.k22 - m.k12 * m.k12;
+    float x1 = (m.k12 * b2 - m.k22 * b1) / det;
+    float x2 = (m.k12 * b1 - m.k11 * b2) / det;
+    if (x1 < 0 || x2 < 0) {
+        x1 = -b1 / m.k11; // only the first pushes
+        x2 = 0;
+        if (x1 < 0 || m.k12 * x1 + b2 < 0) {
+            x1 = 0; // only the second
+            x2 = -b2 / m.k22;
+            if (x2 < 0 || m.k12 * x2 + b1 < 0) {
+                x2 = 0; // neither, which only holds if both separate
+                if (b1 < 0 || b2 < 0) return;
+            }
+        }
+    }
+    apply(m, p1, (x1 - a1) * m.normalX, (x1 - a1) * m.normalY);
+    apply(m, p2, (x2 - a2) * m.normalX, (x2 - a2) * m.normalY);
+    p1.normalImpulse = x1;
+    p2.normalImpulse = x2;
+}
+
+// Sequential impulses at each contact point: friction along the surface,
+// bounded by the normal impulse, then the normal impulse itself, clamped
+// to push only. The two normal impulses of a manifold are solved as one
+// 2x2 block, since each tips the box onto the other point and solving them
+// in turn converges too slowly for stacks. Impulses are accumulated, and
+// the warm start reapplies last step's totals so resting stacks begin
+// close to the answer. Bodies
+// outside the island have no inverse mass and are only read, since other
+// islands may be reading them at the same time.
+void PhysicsWorld::SolveIsland(Manifold* const* manifolds, int count, float dt, int& warmStarted) {
+    float *vx = bodies.vx.data(), *vy = bodies.vy.data(), *w = bodies.w.data();
+    const float *px = bodies.x.data(), *py = bodies.y.data();
+    auto invMass = [&](int i) { return moving[i] ? bodies.invMass[i] : 0.0f; };
+    auto invInertia = [&](int i) { return moving[i] && debug.rotation ? bodies.invInertia[i] : 0.0f; };
+    // Velocity of a's material at p relative to b's
+    auto relative = [&](const Manifold& m, const ContactPoint& p, float& dx, float& dy) {
+        float rax = p.x - px[m.a], ray = p.y - py[m.a];
+        float rbx = p.x - px[m.b], rby = p.y - py[m.b];
+        dx = (vx[m.a] - w[m.a] * ray) - (vx[m.b] - w[m.b] * rby);
+        dy = (vy[m.a] + w[m.a] * rax) - (vy[m.b] + w[m.b] * rbx);
+    };
+    // Impulse (ix, iy) on a at p, and its opposite on b
+    auto apply = [&](const Manifold& m, const ContactPoint& p, float ix, float iy) {
+        if (moving[m.a]) {
+            float im = invMass(m.a);
+            vx[m.a] += ix * im;
+            vy[m.a] += iy * im;
+            w[m.a] += invInertia(m.a) * ((p.x - px[m.a]) * iy - (p.y - py[m.a]) * ix);
+        }
+        if (moving[m.b]) {
+            float im = invMass(m.b);
+            vx[m.b] -= ix * im;
+            vy[m.b] -= iy * im;
+            w[m.b] -= invInertia(m.b) * ((p.x - px[m.b]) * iy - (p.y - py[m.b]) * ix);
+        }
+    };
+
+    for (int n = 0; n < count; n++) {
+        Manifold &m = *manifolds[n];
+        float nx = m.normalX, ny = m.normalY, tx = ny, ty = -nx;
+        float mA = invMass(m.a), mB = invMass(m.b), iA = invInertia(m.a), iB = invInertia(m.b);
+        float leverA[2] = {}, leverB[2] = {};
+        // Parts of the ground row other than the floor are tiles, which don't bounce
+        float bounce = std::max(bodies.restitution[m.a], m.part == 0 ? bodies.restitution[m.b] : 0.0f);
+        for (int k = 0; k < m.count; k++) {
+            ContactPoint &p = m.points[k];
+            // Lever arms crossed with the normal and tangent
+            float rax = p.x - px[m.a], ray = p.y - py[m.a];
+            float rbx = p.x - px[m.b], rby = p.y - py[m.b];
+            float rnA = rax * ny - ray * nx, rnB = rbx * ny - rby * nx;
+            float rtA = rax * ty - ray * tx, rtB = rbx * ty - rby * tx;
+            float kNormal = mA + mB + iA * rnA * rnA + iB * rnB * rnB;
+            float kTangent = mA + mB + iA * rtA * rtA + iB * rtB * rtB;
+            p.normalMass = kNormal > 0 ? 1.0f / kNormal : 0;
+            p.tangentMass = kTangent > 0 ? 1.0f / kTangent : 0;
+            leverA[k] = rnA;
+            leverB[k] = rnB;
+            (k == 0 ? m.k11 : m.k22) = kNormal;
+
+            // Close a gap in one step; push out of overlap a share at a time.
+            // An impact arriving this step bounces back if it was fast enough.
+            float dx, dy;
+            relative(m, p, dx, dy);
+            float vn = dx * nx + dy * ny;
+            p.targetSpeed = p.separation > 0 ? -p.separation / dt : kBaumgarte * std::max(-p.separation - kSlop, 0.0f) / dt;
+            if (bounce > 0 && vn < -kBounceSpeed && p.separation <= -vn * dt) p.targetSpeed = std::max(p.targetSpeed, -bounce * vn);
+
+            if (!debug.warmStart) p.normalImpulse = p.tangentImpulse = 0;
+            if (p.normalImpulse > 0) warmStarted++;
+            apply(m, p, p.normalImpulse * nx + p.tangentImpulse * tx, p.normalImpulse * ny + p.tangentImpulse * ty);
+        }
+        // A nearly singular block means the points act as one; solve them in turn
+        m.k12 = mA + mB + iA * leverA[0] * leverA[1] + iB * leverB[0] * leverB[1];
+        m.block = m.count == 2 && m.k11 * m.k11 < 1000.0f * (m.k11 * m.k22 - m.k12 * m.k12);
+    }
+
+    for (int it = 0; it < debug.iterations; it++) {
+        for (int n = 0; n < count; n++) {
+            Manifold &m = *manifolds[n];
+            float nx = m.normalX, ny = m.normalY, tx = ny, ty = -nx;
+            for (int k = 0; k < m.count; k++) {
+                ContactPoint &p = m.points[k];
+                float dx, dy;
+                relative(m, p, dx, dy);
+                float limit = debug.friction * p.normalImpulse;
+                float lambda = -p.tangentMass * (dx * tx + dy * ty);
+                float total = std::clamp(p.tangentImpulse + lambda, -limit, limit);
+                lambda = total - p.tangentImpulse;
+                p.tangentImpulse = total;
+                apply(m, p, lambda * tx, lambda * ty);
+            }
+            if (m.block) {
+                SolveBlock(m, relative, apply);
+                continue;
+            }
+            for (int k = 0; k < m.count; k++) {
+                ContactPoint &p = m.points[k];
+                float dx, dy;
+                relative(m, p, dx, dy);
+                float lambda = -p.normalMass * (dx * nx + dy * ny - p.targetSpeed);
+                float total = std::max(p.normalImpulse + lambda, 0.0f);
+                lambda = total - p.normalImpulse;
+                p.normalImpulse = total;
+                apply(m, p, lambda * nx, lambda * ny);
+            }
+        }
+    }
+}
+
+// Fraction of (dx, dy) that box can travel before touching target, or 1
+// if it never does; hitX says whether it arrives across the X axis. Targets
+// it already overlaps are left to the discrete test, which is what lets a
+// body caught inside a wall move back out.
+static float TimeOfImpact(const Aabb& box, float dx, float dy, const Aabb& target, bool& hitX) {
+    float enter = -INFINITY, exit = INFINITY;
+    auto axis = [&](float lo, float hi, float tLo, float tHi, float d, bool isX) {
+        if (d == 0) return lo < tHi && tLo < hi;
+        float t0 = (tLo - hi) / d, t1 = (tHi - lo) / d;
+        if (std::min(t0, t1) > enter) {
+            enter = std::min(t0, t1);
+            hitX = isX;
+        }
+        exit = std::min(exit, std::max(t0, t1));
+        return true;
+    };
+    if (!axis(box.minX, box.maxX, target.minX, target.maxX, dx, true)) return 1;
+    if (!axis(box.minY, box.maxY, target.minY, target.maxY, dy, false)) return 1;
+    if (enter >= exit || enter >= 1 || enter < 0) return 1;
+    return enter;
+}
+
+// Earliest time of impact against the statics along (dx, dy), backed off
+// by kSkin so the body stops just short instead of touching. hitX says
+// which axis that first hit blocks.
+float PhysicsWorld::SweepStatics(const std::vector<Entity>& entities, const Entity& e, int self, float dx, float dy, bool& hitX) {
+    Aabb box = Bounds(e);
+    Aabb swept = {box.minX + std::min(dx, 0.0f), box.minY + std::min(dy, 0.0f), box.maxX + std::max(dx, 0.0f), box.maxY + std::max(dy, 0.0f)};
+    candidates.clear();
+    broadphase->Query(swept, candidates);
+    tiles.Statics(swept, candidates);
+    float t = 1;
+    hitX = dx != 0 && dy == 0;
+    auto sweep = [&](const Aabb& target) {
+        bool acrossX = false;
+        float hit = TimeOfImpact(box, dx, dy, target, acrossX);
+        if (hit < t) {
+            t = hit;
+            hitX = acrossX;
+        }
+    };
+    for (int k : candidates) {
+        if (k == self || staticBounds[k].IsEmpty() || !ShouldCollide(e, entities[k])) continue;
+        sweep(staticBounds[k]);
+    }
+    candidateTiles.clear();
+    if (CollidesWithTiles(e)) tiles.Solids(swept, candidateTiles);
+    for (const TileRect &r : candidateTiles) sweep(r.box);
+    debug.sweeps++;
+    if (t >= 1) return 1;
+    debug.sweepHits++;
+    return std::max(t - kSkin / std::sqrt(dx * dx + dy * dy), 0.0f);
+}
+
+// Narrowphase: the candidates' bounds were computed once this step, so
+// every pair is a batch of compares with no half-extent math, and only the
+// few hits involving a rotated box pay for the separating-axis test
+bool PhysicsWorld::HitsStatic(const std::vector<Entity>& entities, const Entity& e, int self) {
+    Aabb box = Bounds(e);
+    candidates.clear();
+    broadphase->Query(box, candidates);
+    tiles.Statics(box, candidates);
+    candidateBounds.Clear();
+    candidateIds.clear();
+    for (int k : candidates) {
+        if (k == self) continue;
+        if (!ShouldCollide(e, entities[k])) {
+            debug.filtered++;
+            continue;
+        }
+        candidateBounds.Push(staticBounds[k]);
+        candidateIds.push_back(k);
+    }
+    debug.pairTests += candidateBounds.count;
+    AabbKernel::OverlapMasks(box, candidateBounds, masks);
+
+    // Unrotated pairs are settled by the box test; the rest go on to SAT
+    Obb shape = Shape(e);
+    candidateShapes.Clear();
+    candidateTiles.clear();
+    if (CollidesWithTiles(e)) tiles.Solids(box, candidateTiles);
+    debug.pairTests += (int)candidateTiles.size();
+    for (const TileRect &r : candidateTiles) {
+        if (!r.box.Overlaps(box)) continue;
+        if (e.rotation == 0) return true;
+        candidateShapes.Push(TileShape(r.box));
+    }
+    for (int h = 0; h < candidateBounds.count; h++) {
+        if (!((masks[h / AabbSoA::kBlock] >> (h % AabbSoA::kBlock)) & 1)) continue;
+        const Entity &o = entities[candidateIds[h]];
+        if (Rotation(e) == 0 && Rotation(o) == 0) return true;
+        candidateShapes.Push(Shape(o));
+    }
+    debug.satTests += candidateShapes.count;
+    return ObbKernel::AnyOverlap(shape, candidateShapes);
+}
+
+Aabb PhysicsWorld::Bounds(const Entity& e) const {
+    return Shape(e).Bounds();
+}
+
+Obb PhysicsWorld::Shape(const Entity& e) const {
+    return Obb::Around(e.x, e.y, e.sx / 2.0f, e.sy / 2.0f, Rotation(e));
+}
+
+// A slab under e, wider than e at any rotation, so its ends never make
+// contact points of their own
+Obb PhysicsWorld::Floor(const Entity& e) const {
+    Aabb box = Bounds(e);
+    float halfW = (box.maxX - box.minX) * 0.5f + 1.0f;
+    return Obb::Around((box.minX + box.maxX) * 0.5f, debug.floorY - kFloorDepth, halfW, kFloorDepth, 0);
+}
@@ -0,0 +1,45 @@
+#include "RenderQueue.h"
+#include <cstring>
+
+uint64_t RenderQueue::MakeKey(uint32_t layer, BlendMode blend, uint32_t shader, uint32_t texture, uint32_t depth) {
+    uint64_t k = layer & ((1u << kLayerBits) - 1);
+    k = (k << kBlendBits) | ((uint32_t)blend & ((1u << kBlendBits) - 1));
+    k = (k << kShaderBits) | (shader & ((1u << kShaderBits) - 1));
+    k = (k << kTextureBits) | (texture & ((1u << kTextureBits) - 1));
+    k = (k << kDepthBits) | (depth & ((1u << kDepthBits) - 1));
+    return k;
+}
+
+void RenderQueue::Sort() {
+    size_t n = items.size();
+    if (n < 2) return;
+    scratch.resize(n);
+
+    // One read builds the histograms for all eight digits
+    uint32_t counts[8][256];
+    memset(counts, 0, sizeof(counts));
+    for (const RenderItem &it : items)
+        for (int d = 0; d < 8; d++)
+            counts[d][(it.key >> (d * 8)) & 0xFF]++;
+
+    RenderItem *src = items.data();
+    RenderItem *dst = scratch.data();
+    for (int d = 0; d < 8; d++) {
+        uint32_t *c = counts[d];
+        // Every key shares this digit: the pass would be a plain copy
+        if (c[(src[0].key >> (d * 8)) & 0xFF] == n) continue;
+
+        uint32_t offsets[256];
+        uint32_t sum = 0;
+        for (int b = 0; b < 256; b++) {
+            offsets[b] = sum;
+            sum += c[b];
+        }
+        for (size_t i = 0; i < n; i++)
+            dst[offsets[(src[i].key >> (d * 8)) & 0xFF]++] = src[i];
+        RenderItem *t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != items.data()) items.swap(scratch);
+}
@@ -4,8 +4,12 @@
 #include "imgui_impl_sdl2.h"
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
+#include <climits>
 #include <cmath>
 #include <fstream>
+#include <thread>
+#include <tuple>
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "Input.h"
@@ -20,9 +24,10 @@ layout (location = 1) in vec2 aTexCoord;
 out vec2 TexCoord;
 uniform mat4 transform;
 uniform mat4 view;
+uniform vec4 uvRect;
 void main() {
     gl_Position = view * transform * vec4(aPos, 1.0);
-    TexCoord = aTexCoord;
+    TexCoord = mix(uvRect.xy, uvRect.zw, aTexCoord);
 }
 )";
 
@@ -31,14 +36,76 @@ const char *fSrc = R"(
 in vec2 TexCoord;
 out vec4 FragColor;
 uniform sampler2D tex;
+uniform sampler2DArray texArray;
+uniform float layer;
 uniform vec3 tint;
 uniform float alpha;
 void main() {
-    vec4 c = texture(tex, TexCoord);
+    vec4 c = layer < 0.0 ? texture(tex, TexCoord) : texture(texArray, vec3(TexCoord, layer));
     FragColor = vec4(c.rgb * tint, c.a * alpha);
 }
 )";
 
+// Batched sprites: vertices arrive pre-transformed with their own tint/alpha
+const char *batchVSrc = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in float aLayer;
+out vec2 TexCoord;
+out vec4 Color;
+flat out float Layer;
+uniform mat4 view;
+void main() {
+    gl_Position = view * vec4(aPos, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    Color = aColor;
+    Layer = aLayer;
+}
+)";
+
+// Instanced sprites: the quad is placed per instance on the GPU
+const char *instanceVSrc = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec2 iPos;
+layout (location = 3) in float iRotation;
+layout (location = 4) in vec2 iScale;
+layout (location = 5) in vec4 iColor;
+layout (location = 6) in float iLayer;
+layout (location = 7) in vec4 iUv;
+out vec2 TexCoord;
+out vec4 Color;
+flat out float Layer;
+uniform mat4 view;
+void main() {
+    float c = cos(iRotation), s = sin(iRotation);
+    vec2 p = aPos.xy * iScale;
+    vec2 world = vec2(c * p.x - s * p.y, s * p.x + c * p.y) + iPos;
+    gl_Position = view * vec4(world, 0.0, 1.0);
+    TexCoord = mix(iUv.xy, iUv.zw, aTexCoord);
+    Color = iColor;
+    Layer = iLayer;
+}
+)";
+
+// Layer >= 0 samples the texture array on unit 1, otherwise the 2D texture on unit 0
+const char *batchFSrc = R"(
+#version 330 core
+in vec2 TexCoord;
+in vec4 Color;
+flat in float Layer;
+out vec4 FragColor;
+uniform sampler2D tex;
+uniform sampler2DArray texArray;
+void main() {
+    vec4 c = Layer < 0.0 ? texture(tex, TexCoord) : texture(texArray, vec3(TexCoord, Layer));
+    FragColor = c * Color;
+}
+)";
+
 const char *gridVSrc = R"(
 #version 330 core
 layout (location = 0) in vec3 aPos;
@@ -98,9 +165,12 @@ void main() {
 )";
 
 Renderer::Renderer() {
+    textureHandles["default"] = 0;
+    textureTable.resize(1);
 }
 
 Renderer::~Renderer() {
+    if (!ImGui::GetCurrentContext()) return; // never initialised, e.g. a headless benchmark
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
@@ -132,16 +202,10 @@ void Renderer::Init(SDL_Window* window) {
 }
 
 void Renderer::InitShader() {
-    unsigned int vs = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vs, 1, &vSrc, 0);
-    glCompileShader(vs);
-    unsigned int fs = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fs, 1, &fSrc, 0);
-    glCompileShader(fs);
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vs);
-    glAttachShader(shaderProgram, fs);
-    glLinkProgram(shaderProgram);
+    spriteShader.Build(vSrc, fSrc);
+    batchShader.Build(batchVSrc, batchFSrc);
+    // Instanced path shares the batch fragment shader
+    instanceShader.Build(instanceVSrc, batchFSrc);
 }
 
 void Renderer::InitBuffers() {
@@ -162,65 +226,100 @@ void Renderer::InitBuffers() {
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
+
+    batch.Init(16384);
+    instancer.Init(VBO, EBO, 65536);
+    staticCache.Init();
 }
 
 void Renderer::InitInfiniteGrid() {
-    unsigned int vs = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vs, 1, &gridVSrc, 0);
-    glCompileShader(vs);
-    unsigned int fs = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fs, 1, &gridFSrc, 0);
-    glCompileShader(fs);
-    gridProgram = glCreateProgram();
-    glAttachShader(gridProgram, vs);
-    glAttachShader(gridProgram, fs);
-    glLinkProgram(gridProgram);
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    gridShader.Build(gridVSrc, gridFSrc);
 }
 
 void Renderer::RefreshTextures() {
-    textures.clear();
+    if (!ownedTextures.empty())
+        glDeleteTextures((int)ownedTextures.size(), ownedTextures.data());
+    ownedTextures.clear();
     textureList.clear();
+    std::map<std::string, TextureRegion> textures;
     if (!fs::exists("assets"))
         fs::create_directory("assets");
     
+    // Decode everything to RGBA8 first so it can be packed
+    std::vector<AtlasImage> images;
+    stbi_set_flip_vertically_on_load(true);
     for (const auto &entry : fs::directory_iterator("assets")) {
         std::string path = entry.path().string();
         std::string filename = entry.path().filename().string();
         if (path.find(".png") != std::string::npos || path.find(".jpg") != std::string::npos) {
-            unsigned int id = LoadTexture(path.c_str());
-            textures[filename] = id;
+            int w, h, n;
+            unsigned char *d = stbi_load(path.c_str(), &w, &h, &n, 4);
+            if (!d) continue;
+            images.push_back({filename, w, h, d});
             textureList.push_back(filename);
         }
     }
     
     // Default white texture
-    if (textures.find("default") == textures.end()) {
-        unsigned int id;
-        glGenTextures(1, &id);
-        unsigned char white[] = {255, 255, 255, 255};
-        glBindTexture(GL_TEXTURE_2D, id);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
-        textures["default"] = id;
+    static const unsigned char white[] = {255, 255, 255, 255};
+    bool hasDefault = false;
+    for (auto &img : images) hasDefault |= (img.name == "default");
+    if (!hasDefault) {
+        images.push_back({"default", 1, 1, white});
         textureList.push_back("default");
     }
+
+    // Same-size groups go to texture arrays, odd sizes stay standalone
+    std::vector<AtlasImage> rest;
+    std::vector<unsigned int> arrays;
+    if (packing == TexturePacking::Array) arrays = arrayBuilder.Build(images, textures, rest);
+    else rest = images;
+    textureArrays = (int)arrays.size();
+    ownedTextures.insert(ownedTextures.end(), arrays.begin(), arrays.end());
+
+    std::vector<AtlasImage> packed;
+    for (auto &img : rest) {
+        if (packing == TexturePacking::Atlas && TextureAtlas::Fits(img.w, img.h)) {
+            packed.push_back(img);
+        } else {
+            TextureRegion r;
+            r.texture = CreateTexture(img.w, img.h, img.pixels);
+            textures[img.name] = r;
+        }
+    }
+    std::vector<unsigned int> pages = atlas.Build(packed, textures);
+    atlasPages = (int)pages.size();
+    ownedTextures.insert(ownedTextures.end(), pages.begin(), pages.end());
+
+    for (auto &img : images)
+        if (img.pixels != white) stbi_image_free((void *)img.pixels);
+
+    // Re-point existing handles; names that vanished fall back to default
+    const TextureRegion defaultRegion = textures["default"];
+    for (auto &r : textureTable) r = defaultRegion;
+    for (auto &[name, region] : textures)
+        textureTable[GetTextureHandle(name)] = region;
+    staticCache.MarkAllDirty(); // baked UVs and textures are stale
+}
+
+TextureHandle Renderer::GetTextureHandle(const std::string& name) {
+    auto it = textureHandles.find(name);
+    if (it != textureHandles.end()) return it->second;
+    // Unknown names get a slot too, so they resolve if the asset shows up later
+    TextureHandle h = (TextureHandle)textureTable.size();
+    textureHandles[name] = h;
+    textureTable.push_back(textureTable[0]);
+    return h;
 }
 
-unsigned int Renderer::LoadTexture(const char* p) {
+unsigned int Renderer::CreateTexture(int w, int h, const unsigned char* rgba) {
     unsigned int id;
     glGenTextures(1, &id);
-    int w, h, n;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *d = stbi_load(p, &w, &h, &n, 0);
-    if (d) {
-        GLenum f = (n == 4) ? GL_RGBA : GL_RGB;
-        glBindTexture(GL_TEXTURE_2D, id);
-        glTexImage2D(GL_TEXTURE_2D, 0, f, w, h, 0, f, GL_UNSIGNED_BYTE, d);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        stbi_image_free(d);
-    }
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    ownedTextures.push_back(id);
     return id;
 }
 
@@ -239,13 +338,47 @@ void Renderer::CreateView(float *m, Camera c, float aspect) {
     m[3] = 0;               m[7] = 0;      m[11] = 0; m[15] = 1;
 }
 
-bool Renderer::CheckPointInside(Entity &e, float px, float py) {
-    float halfX = e.sx / 2.0f;
-    float halfY = e.sy / 2.0f;
-    return (px > e.x - halfX && px < e.x + halfX && py > e.y - halfY && py < e.y + halfY);
+Aabb Renderer::ViewBounds(const Camera& c, float aspect) {
+    // Inverse of CreateView: clip space -1..1 maps to zoom-scaled world units
+    return Aabb::Around(c.x, c.y, aspect / c.zoom, 1.0f / c.zoom);
+}
+
+bool Renderer::TakePickRequest(float& x, float& y) {
+    if (!pickRequested) return false;
+    pickRequested = false;
+    x = pickX;
+    y = pickY;
+    return true;
+}
+
+// The entity drawn on top wins: highest layer, then cached statics below
+// dynamics, then the later index
+int Renderer::Pick(const std::vector<Entity>& entities, const std::vector<int>& hits) const {
+    bool cached = UseStaticCache();
+    auto drawKey = [&](int i) {
+        const Entity &e = entities[i];
+        return std::make_tuple(std::clamp(e.layer, 0, kParticleLayer - 1), cached && !e.isStatic, i);
+    };
+    int best = -1;
+    for (int i : hits)
+        if (i >= 0 && i < (int)entities.size() && (best < 0 || drawKey(best) < drawKey(i))) best = i;
+    return best;
 }
 
-void Renderer::Render(SDL_Window* window, std::vector<Entity>& entities, std::vector<Particle>& particles, const Camera& cam, int& selected, std::vector<std::vector<Entity>>& undoStack) {
+// Anything the static cache bakes into its vertices
+bool Renderer::BakedFieldsDiffer(const Entity& a, const Entity& b) {
+    return a.x != b.x || a.y != b.y || a.rotation != b.rotation || a.sx != b.sx || a.sy != b.sy ||
+           a.color[0] != b.color[0] || a.color[1] != b.color[1] || a.color[2] != b.color[2] ||
+           a.texture != b.texture || a.layer != b.layer || a.isStatic != b.isStatic;
+}
+
+// Anything else the physics thread's copy needs to hear about
+bool Renderer::PhysicsFieldsDiffer(const Entity& a, const Entity& b) {
+    return a.hasGravity != b.hasGravity || a.collisionCategory != b.collisionCategory || a.collisionMask != b.collisionMask ||
+           a.mass != b.mass || a.restitution != b.restitution;
+}
+
+void Renderer::Render(SDL_Window* window, std::vector<Entity>& entities, const std::vector<Particle>& particles, const Camera& cam, int& selected, std::vector<std::vector<Entity>>& undoStack, SceneEdits& edits, PhysicsDebug& physics) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame();
     ImGui::NewFrame();
@@ -289,12 +422,11 @@ void Renderer::Render(SDL_Window* window, std::vector<Entity>& entities, std::ve
              float wx = ndcX * aspect / cam.zoom + cam.x;
              float wy = ndcY / cam.zoom + cam.y;
 
-             for (int k = (int)entities.size() - 1; k >= 0; k--) {
-                if (CheckPointInside(entities[k], wx, wy)) {
-                    selected = k;
-                    break;
-                }
-             }
+             // The simulation's scene query finds what is under the cursor;
+             // its answer comes back through Pick
+             pickRequested = true;
+             pickX = wx;
+             pickY = wy;
         }
     }
 
@@ -313,6 +445,10 @@ void Renderer::Render(SDL_Window* window, std::vector<Entity>& entities, std::ve
     if (ImGui::Button("+ New Entity", ImVec2(-1, 30))) {
         undoStack.push_back(entities); // Save before adding
         entities.push_back({"Prop", cam.x, cam.y, 0, 0.3f, 0.3f, {1,1,1}, "default", true, false, 0});
+        entities.back().prevX = cam.x;
+        entities.back().prevY = cam.y;
+        edits.replaced = true;
+        cullRebuild = true;
     }
     ImGui::End();
 
@@ -322,6 +458,7 @@ void Renderer::Render(SDL_Window* window, std::vector<Entity>& entities, std::ve
     ImGui::Begin("Inspector", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
     if (selected >= 0 && selected < (int)entities.size()) {
         Entity &e = entities[selected];
+        Entity before = e;
         ImGui::Text("Properties");
         ImGui::Separator();
         char nBuf[64]; strcpy(nBuf, e.name.c_str());
@@ -330,11 +467,15 @@ void Renderer::Render(SDL_Window* window, std::vector<Entity>& entities, std::ve
         if (ImGui::BeginCombo("Texture", e.textureName.c_str())) {
             for (auto &texName : textureList) {
                 bool is_selected = (e.textureName == texName);
-                if (ImGui::Selectable(texName.c_str(), is_selected)) e.textureName = texName;
+                if (ImGui::Selectable(texName.c_str(), is_selected)) {
+                    e.textureName = texName;
+                    e.texture = GetTextureHandle(texName);
+                }
                 if (is_selected) ImGui::SetItemDefaultFocus();
             }
             ImGui::EndCombo();
         }
+        ImGui::DragInt("Layer", &e.layer, 0.1f, 0, kParticleLayer - 1);
         ImGui::DragFloat("Pos X", &e.x, 0.01f);
         ImGui::DragFloat("Pos Y", &e.y, 0.01f);
         ImGui::SliderFloat("Rot", &e.rotation, -3.14f, 3.14f);
@@ -361,11 +502,27 @@ void Renderer::Render(SDL_Window* window, std::vector<Entity>& entities, std::ve
         ImGui::ColorEdit3("Color", e.color);
         ImGui::Checkbox("Gravity", &e.hasGravity);
         ImGui::Checkbox("Is Static", &e.isStatic);
+        ImGui::DragFloat("Mass", &e.mass, 0.01f, 0.01f, 100.0f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+        ImGui::SliderFloat("Restitution", &e.restitution, 0.0f, 1.0f);
+        ImGui::InputScalar("Category", ImGuiDataType_U16, &e.collisionCategory, nullptr, nullptr, "%04X", ImGuiInputTextFlags_CharsHexadecimal);
+        ImGui::InputScalar("Collides With", ImGuiDataType_U16, &e.collisionMask, nullptr, nullptr, "%04X", ImGuiInputTextFlags_CharsHexadecimal);
+        if (e.collisionCategory == 0) e.collisionCategory = before.collisionCategory;
+        if (BakedFieldsDiffer(before, e)) {
+            if (before.isStatic || e.isStatic) staticCache.MarkDirty(selected);
+            cullMoved.push_back(selected);
+            // Edits teleport; don't smear them across the next physics step
+            e.prevX = e.x;
+            e.prevY = e.y;
+            e.prevRotation = e.rotation;
+        }
+        if (BakedFieldsDiffer(before, e) || PhysicsFieldsDiffer(before, e)) edits.touched.push_back(selected);
         ImGui::Dummy(ImVec2(0, 20));
         if (ImGui::Button("DELETE ENTITY", ImVec2(-1, 30))) {
             undoStack.push_back(entities); // Save state before delete
             entities.erase(entities.begin() + selected);
             selected = 0;
+            edits.replaced = true;
+            cullRebuild = true;
         }
     }
     ImGui::End();
@@ -376,53 +533,112 @@ void Renderer::Render(SDL_Window* window, std::vector<Entity>& entities, std::ve
     ImGui::TextColored(ImVec4(1,1,1,0.5f), "WASD-Move | Space-Particle | Middle-Pan | Scroll-Zoom");
     ImGui::End();
 
+    // Render Stats (previous frame)
+    ImGui::SetNextWindowPos(ImVec2(leftPanelWidth + 10, 10));
+    ImGui::Begin("Render Stats", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoBackground);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "%.1f FPS | Draws: %d | Verts: %d | Sprites: %d", ImGui::GetIO().Framerate, stats.drawCalls, stats.vertices, stats.sprites);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "Culled: %d of %d", stats.culled, stats.culled + stats.sprites);
+    ImGui::SameLine();
+    ImGui::Checkbox("Cull", &cullSprites);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "Static: %d in %d chunk(s) | %d rebake(s)", staticCache.StaticCount(), staticCache.ChunkCount(), staticCache.Rebakes());
+    ImGui::SameLine();
+    ImGui::Checkbox("Cache", &cacheStatics);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "GL state: %d issued | %d elided", glState.Stats().issued, glState.Stats().elided);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "Streaming: %s | %d stall(s)", batch.Stream().IsPersistent() ? "persistent ring" : "orphaning",
+                       batch.Stream().Stalls() + instancer.Stream().Stalls());
+    int path = (int)spritePath;
+    ImGui::SetNextItemWidth(140);
+    if (ImGui::Combo("Sprite Path", &path, "Immediate\0Batched\0Instanced\0")) spritePath = (SpritePath)path;
+    int pack = (int)packing;
+    ImGui::SetNextItemWidth(140);
+    if (ImGui::Combo("Textures", &pack, "Standalone\0Atlas\0Array\0")) {
+        packing = (TexturePacking)pack;
+        RefreshTextures();
+    }
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "%d atlas page(s) | %d array(s)", atlasPages, textureArrays);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "Physics: %d bodies | %d step(s) | %d pair tests (%d SAT, %d filtered) | %.3f ms", physics.bodies, physics.steps, physics.pairTests, physics.satTests, physics.filtered, physics.stepMs);
+    ImGui::SameLine();
+    ImGui::Checkbox("Rotation", &physics.rotation);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "Bodies: %d awake | %d sleeping", physics.awake, physics.sleeping);
+    ImGui::SameLine();
+    ImGui::Checkbox("Sleep", &physics.sleep);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "Contacts: %d | %d point(s) warm started", physics.contacts, physics.warmStarted);
+    ImGui::SameLine();
+    ImGui::Checkbox("Warm Start", &physics.warmStart);
+    ImGui::SetNextItemWidth(140);
+    ImGui::SliderInt("Solver Iterations", &physics.iterations, 1, 32);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "Islands: %d on %d thread(s)", physics.islands, physics.threadsUsed);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "CCD: %d sweep(s) | %d cut short", physics.sweeps, physics.sweepHits);
+    ImGui::SameLine();
+    ImGui::Checkbox("CCD", &physics.ccd);
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "Tiles: %d solid in %d chunk(s) | %d static(s) baked, %d listed", physics.tileSolid, physics.tileChunks, physics.tileBaked, physics.tileListed);
+    ImGui::SameLine();
+    ImGui::Checkbox("Tile Map", &physics.tiles);
+    ImGui::SetNextItemWidth(140);
+    ImGui::SliderFloat("Tile Size", &physics.tileSize, 0.05f, 1.0f, "%.2f");
+    ImGui::TextColored(ImVec4(1,1,1,0.7f), "Scene queries: %d exact test(s)", physics.queryTests);
+    ImGui::SetNextItemWidth(140);
+    ImGui::SliderInt("Physics Threads", &physics.threads, 0, (int)std::thread::hardware_concurrency(), physics.threads ? "%d" : "Auto");
+    ImGui::SetNextItemWidth(140);
+    ImGui::SliderFloat("Gravity", &physics.gravity, 0.0f, 20.0f, "%.1f");
+    ImGui::SetNextItemWidth(140);
+    ImGui::SliderFloat("Friction", &physics.friction, 0.0f, 1.0f, "%.2f");
+    ImGui::Checkbox("Floor", &physics.floor);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80);
+    ImGui::DragFloat("Floor Y", &physics.floorY, 0.01f);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80);
+    ImGui::SliderFloat("Bounce", &physics.floorRestitution, 0.0f, 1.0f, "%.2f");
+    ImGui::SetNextItemWidth(140);
+    ImGui::SliderInt("Physics Hz", &physics.hz, 10, 240);
+    ImGui::SetNextItemWidth(140);
+    ImGui::SliderInt("Max Substeps", &physics.maxSubsteps, 1, 16);
+    int broad = (int)physics.broadphase;
+    ImGui::SetNextItemWidth(140);
+    if (ImGui::Combo("Broadphase", &broad, "Brute Force\0Spatial Hash\0AABB Tree\0Sweep and Prune\0")) physics.broadphase = (BroadphaseType)broad;
+    int isa = (int)AabbKernel::Active();
+    ImGui::SetNextItemWidth(140);
+    if (ImGui::Combo("AABB Kernel", &isa, "Scalar\0SSE\0AVX2\0")) AabbKernel::Select((AabbKernel::Isa)isa);
+    ImGui::End();
+
     // --- Scene Render ---
     glClearColor(0.12f, 0.12f, 0.15f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     
     glViewport((int)sceneX, 0, (int)sceneW, (int)sceneH);
-    glUseProgram(shaderProgram);
+
+    // Rebakes bind buffers behind the state cache, so do them before it resets
+    if (UseStaticCache()) staticCache.Update(entities, textureTable, kParticleLayer - 1);
+
+    // ImGui rendered with its own state last frame
+    glState.Invalidate();
+    glState.ResetStats();
+    glState.SetBlend(true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
     float vm[16];
     float aspect = sceneW / sceneH;
     CreateView(vm, cam, aspect);
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, 0, vm);
 
-    // Draw Grid
     // Draw Infinite Grid
-    glUseProgram(gridProgram);
-    glUniformMatrix4fv(glGetUniformLocation(gridProgram, "view"), 1, 0, vm);
+    glState.UseProgram(gridShader.Id());
+    glUniformMatrix4fv(gridShader.Location(UniformSlot::View), 1, 0, vm);
     float gridTransform[16];
     // Scale quad to cover view. Standard quad is 1x1.
     CreateTransform(gridTransform, cam.x, cam.y, 0, 1000.0f / cam.zoom, 1000.0f / cam.zoom);
-    glUniformMatrix4fv(glGetUniformLocation(gridProgram, "transform"), 1, 0, gridTransform);
+    glUniformMatrix4fv(gridShader.Location(UniformSlot::Transform), 1, 0, gridTransform);
     
-    glBindVertexArray(VAO); // Re-use standard quad
+    glState.BindVertexArray(VAO); // Re-use standard quad
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
-    // Draw Entities
-    glBindVertexArray(VAO);
-    for (auto &e : entities) {
-        float tm[16];
-        CreateTransform(tm, e.x, e.y, e.rotation, e.sx, e.sy);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "transform"), 1, 0, tm);
-        glUniform3f(glGetUniformLocation(shaderProgram, "tint"), e.color[0], e.color[1], e.color[2]);
-        glUniform1f(glGetUniformLocation(shaderProgram, "alpha"), 1.0f);
-        
-        unsigned int tid = textures.count(e.textureName) ? textures[e.textureName] : textures["default"];
-        glBindTexture(GL_TEXTURE_2D, tid);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    }
-    
-    // Draw Particles
-    for (auto &p : particles) {
-        float tm[16];
-        CreateTransform(tm, p.x, p.y, 0, 0.04f, 0.04f);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "transform"), 1, 0, tm);
-        glUniform3f(glGetUniformLocation(shaderProgram, "tint"), p.color[0], p.color[1], p.color[2]);
-        glUniform1f(glGetUniformLocation(shaderProgram, "alpha"), p.life);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    }
+    stats = RenderStats();
+    interpAlpha = physics.alpha;
+    interpStep = 1.0f / std::max(physics.hz, 1);
+    DrawSprites(vm, ViewBounds(cam, aspect), entities, particles);
+    // Fence this frame's slice of the streaming rings
+    batch.EndFrame();
+    instancer.EndFrame();
 
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -431,6 +647,203 @@ void Renderer::Render(SDL_Window* window, std::vector<Entity>& entities, std::ve
 
 
 
+Renderer::SpriteDesc Renderer::GetSprite(const RenderItem& item, const std::vector<Entity>& entities, const std::vector<Particle>& particles) const {
+    if (item.payload & kParticleBit) {
+        const Particle &p = particles[item.payload & ~kParticleBit];
+        // Particles fly straight, so their position one step back is exact
+        float back = (1.0f - interpAlpha) * interpStep;
+        return {&textureTable[0], p.x - p.vx * back, p.y - p.vy * back, 0, kParticleSize, kParticleSize, p.color, p.life};
+    }
+    const Entity &e = entities[item.payload];
+    float x = e.prevX + (e.x - e.prevX) * interpAlpha;
+    float y = e.prevY + (e.y - e.prevY) * interpAlpha;
+    float r = e.prevRotation + (e.rotation - e.prevRotation) * interpAlpha;
+    return {&ResolveTexture(e.texture), x, y, r, e.sx, e.sy, e.color, 1.0f};
+}
+
+void Renderer::ApplyBlend(BlendMode mode) {
+    if (mode == BlendMode::Additive) glState.SetBlend(true, GL_SRC_ALPHA, GL_ONE);
+    else glState.SetBlend(true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+// Bounds of the entity at any rotation it is drawn with, over the whole
+// path it is interpolated along until the next step
+void Renderer::IndexForCulling(const std::vector<Entity>& entities, int i) {
+    const Entity &e = entities[i];
+    float c = std::fabs(cos(e.rotation)), s = std::fabs(sin(e.rotation));
+    float hx = (c * std::fabs(e.sx) + s * std::fabs(e.sy)) * 0.5f;
+    float hy = (s * std::fabs(e.sx) + c * std::fabs(e.sy)) * 0.5f;
+    Aabb b = Aabb::Around(e.x, e.y, hx, hy);
+    if (e.prevX != e.x || e.prevY != e.y) {
+        Aabb p = Aabb::Around(e.prevX, e.prevY, hx, hy);
+        b = {std::min(b.minX, p.minX), std::min(b.minY, p.minY), std::max(b.maxX, p.maxX), std::max(b.maxY, p.maxY)};
+    }
+    cullBounds[i] = b;
+    if (cullProxies[i] < 0) cullProxies[i] = cullTree.CreateProxy(b, i);
+    else cullTree.MoveProxy(cullProxies[i], b);
+    cullStatics += (int)e.isStatic - cullStatic[i];
+    cullStatic[i] = e.isStatic;
+}
+
+// Refits the entities marked as moved, or reindexes all of them after the
+// list changed
+void Renderer::RefreshCullIndex(const std::vector<Entity>& entities) {
+    if (cullRebuild || cullProxies.size() != entities.size()) {
+        cullTree.Clear();
+        cullProxies.assign(entities.size(), -1);
+        cullBounds.resize(entities.size());
+        cullStatic.assign(entities.size(), 0);
+        cullStatics = 0;
+        for (int i = 0; i < (int)entities.size(); i++) IndexForCulling(entities, i);
+        cullRebuild = false;
+    } else {
+        for (int i : cullMoved)
+            if (i >= 0 && i < (int)entities.size()) IndexForCulling(entities, i);
+    }
+    cullMoved.clear();
+}
+
+// Fills `visible` with the entities whose rotated bounds touch the view
+void Renderer::CollectVisible(const Aabb& view, const std::vector<Entity>& entities, bool skipStatic) {
+    visible.clear();
+    if (!cullSprites) {
+        // Nothing refits while culling is off, so start over when it's back on
+        cullRebuild = true;
+        cullMoved.clear();
+        for (int i = 0; i < (int)entities.size(); i++)
+            if (!skipStatic || !entities[i].isStatic) visible.push_back(i);
+        return;
+    }
+    RefreshCullIndex(entities);
+    cullTree.Query(view, [&](int id) {
+        if (cullBounds[id].Overlaps(view) && !(skipStatic && entities[id].isStatic)) visible.push_back(id);
+    });
+    std::sort(visible.begin(), visible.end()); // index order keeps submission depth stable
+    int candidates = (int)entities.size() - (skipStatic ? cullStatics : 0);
+    stats.culled += candidates - (int)visible.size();
+}
+
+void Renderer::DrawSprites(const float* vm, const Aabb& view, const std::vector<Entity>& entities, const std::vector<Particle>& particles) {
+    bool statics = UseStaticCache();
+    CollectVisible(view, entities, statics);
+    if (statics) stats.culled += staticCache.Cull(view);
+
+    // Build the queue; depth is the submission index so equal keys keep vector order
+    queue.Clear();
+    for (int i : visible) {
+        const Entity &e = entities[i];
+        queue.Push(RenderQueue::MakeKey(std::clamp(e.layer, 0, kParticleLayer - 1), BlendMode::Alpha, 0, ResolveTexture(e.texture).texture, i), i);
+    }
+    uint32_t particleTex = textureTable[0].texture;
+    Aabb particleView = view;
+    particleView.minX -= kParticleSize; particleView.minY -= kParticleSize;
+    particleView.maxX += kParticleSize; particleView.maxY += kParticleSize;
+    for (int i = 0; i < (int)particles.size(); i++) {
+        const Particle &p = particles[i];
+        // Particles are tiny and short-lived; a point test beats indexing them
+        if (cullSprites && (p.x < particleView.minX || p.x > particleView.maxX || p.y < particleView.minY || p.y > particleView.maxY)) {
+            stats.culled++;
+            continue;
+        }
+        queue.Push(RenderQueue::MakeKey(kParticleLayer, BlendMode::Alpha, 0, particleTex, (uint32_t)(entities.size() + i)), kParticleBit | i);
+    }
+    queue.Sort();
+
+    BlendMode blend = BlendMode::Alpha;
+    ApplyBlend(blend);
+
+    // Cached statics draw with the batch shader ahead of same-layer dynamic
+    // sprites; nextStatic is the lowest static layer not yet drawn
+    if (statics && spritePath == SpritePath::Instanced) {
+        glState.UseProgram(batchShader.Id());
+        glUniformMatrix4fv(batchShader.Location(UniformSlot::View), 1, 0, vm);
+    }
+    int nextStatic = statics ? staticCache.NextLayer(0) : INT_MAX;
+    auto drawStatics = [&](int throughLayer) {
+        ApplyBlend(blend = BlendMode::Alpha);
+        glState.UseProgram(batchShader.Id());
+        staticCache.DrawLayers(nextStatic, throughLayer, glState, stats);
+        nextStatic = staticCache.NextLayer(throughLayer + 1);
+    };
+
+    if (spritePath == SpritePath::Batched) {
+        glState.UseProgram(batchShader.Id());
+        glUniformMatrix4fv(batchShader.Location(UniformSlot::View), 1, 0, vm);
+        batch.Begin();
+        for (const RenderItem &item : queue.Items()) {
+            int layer = (int)RenderQueue::KeyLayer(item.key);
+            if (layer >= nextStatic) {
+                batch.End(glState, stats);
+                drawStatics(layer);
+                batch.Begin();
+            }
+            BlendMode b = RenderQueue::KeyBlend(item.key);
+            if (b != blend) {
+                batch.End(glState, stats);
+                ApplyBlend(blend = b);
+                batch.Begin();
+            }
+            SpriteDesc d = GetSprite(item, entities, particles);
+            batch.Draw(*d.tex, d.x, d.y, d.rotation, d.sx, d.sy, d.color, d.alpha);
+        }
+        batch.End(glState, stats);
+        if (nextStatic != INT_MAX) drawStatics(kParticleLayer);
+    } else if (spritePath == SpritePath::Instanced) {
+        glState.UseProgram(instanceShader.Id());
+        glUniformMatrix4fv(instanceShader.Location(UniformSlot::View), 1, 0, vm);
+        instancer.Begin();
+        for (const RenderItem &item : queue.Items()) {
+            int layer = (int)RenderQueue::KeyLayer(item.key);
+            if (layer >= nextStatic) {
+                instancer.End(glState, stats);
+                drawStatics(layer);
+                glState.UseProgram(instanceShader.Id());
+                instancer.Begin();
+            }
+            BlendMode b = RenderQueue::KeyBlend(item.key);
+            if (b != blend) {
+                instancer.End(glState, stats);
+                ApplyBlend(blend = b);
+                instancer.Begin();
+            }
+            SpriteDesc d = GetSprite(item, entities, particles);
+            instancer.Draw(*d.tex, d.x, d.y, d.rotation, d.sx, d.sy, d.color, d.alpha);
+        }
+        instancer.End(glState, stats);
+        if (nextStatic != INT_MAX) drawStatics(kParticleLayer);
+    } else {
+        glState.UseProgram(spriteShader.Id());
+        glUniformMatrix4fv(spriteShader.Location(UniformSlot::View), 1, 0, vm);
+        int transformLoc = spriteShader.Location(UniformSlot::Transform);
+        int tintLoc = spriteShader.Location(UniformSlot::Tint);
+        int alphaLoc = spriteShader.Location(UniformSlot::Alpha);
+        int uvLoc = spriteShader.Location(UniformSlot::UvRect);
+        int layerLoc = spriteShader.Location(UniformSlot::Layer);
+
+        glState.BindVertexArray(VAO);
+        for (const RenderItem &item : queue.Items()) {
+            BlendMode b = RenderQueue::KeyBlend(item.key);
+            if (b != blend) ApplyBlend(blend = b);
+
+            SpriteDesc d = GetSprite(item, entities, particles);
+            float tm[16];
+            CreateTransform(tm, d.x, d.y, d.rotation, d.sx, d.sy);
+            glUniformMatrix4fv(transformLoc, 1, 0, tm);
+            glUniform3f(tintLoc, d.color[0], d.color[1], d.color[2]);
+            glUniform1f(alphaLoc, d.alpha);
+            glUniform4f(uvLoc, d.tex->u0, d.tex->v0, d.tex->u1, d.tex->v1);
+            glUniform1f(layerLoc, (float)d.tex->layer);
+            SpriteBatch::BindTexture(glState, d.tex->texture, d.tex->IsArray());
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        }
+
+        int count = (int)queue.Items().size();
+        stats.drawCalls += count;
+        stats.vertices += count * 4;
+        stats.sprites += count;
+    }
+}
+
 void Renderer::SetupUIStyle() {
     ImGuiStyle& style = ImGui::GetStyle();
     ImVec4* colors = style.Colors;
@@ -0,0 +1,168 @@
+#include "SceneQuery.h"
+#include <algorithm>
+#include <cmath>
+
+static Obb ShapeOf(const Entity& e) {
+    return Obb::Around(e.x, e.y, e.sx / 2.0f, e.sy / 2.0f, e.rotation);
+}
+
+// Slabs in the box's own frame: where the ray enters, and through which side
+static bool RayObb(const Ray& ray, const Obb& b, float& fraction, float& normalX, float& normalY) {
+    float ox = ray.x - b.cx, oy = ray.y - b.cy;
+    float local[2] = {ox * b.c + oy * b.s, oy * b.c - ox * b.s};
+    float dir[2] = {ray.dx * b.c + ray.dy * b.s, ray.dy * b.c - ray.dx * b.s};
+    float half[2] = {b.hx, b.hy};
+    float enter = -INFINITY, exit = INFINITY;
+    int axis = 0;
+    float side = 0;
+    for (int k = 0; k < 2; k++) {
+        if (dir[k] == 0) {
+            if (std::fabs(local[k]) > half[k]) return false;
+            continue;
+        }
+        float t0 = (-half[k] - local[k]) / dir[k], t1 = (half[k] - local[k]) / dir[k];
+        if (std::min(t0, t1) > enter) {
+            enter = std::min(t0, t1);
+            axis = k;
+            side = dir[k] > 0 ? -1.0f : 1.0f;
+        }
+        exit = std::min(exit, std::max(t0, t1));
+    }
+    if (enter > exit || enter < 0 || enter > 1) return false;
+    float lx = axis == 0 ? side : 0, ly = axis == 1 ? side : 0;
+    fraction = enter;
+    normalX = lx * b.c - ly * b.s;
+    normalY = lx * b.s + ly * b.c;
+    return true;
+}
+
+void SceneQuery::Bind(const std::vector<Entity>& scene, Broadphase& broadphase, const TileMap* tileMap, JobPool* jobs) {
+    entities = &scene;
+    index = &broadphase;
+    tiles = tileMap;
+    pool = jobs;
+}
+
+template <typename F>
+void SceneQuery::ForEachQuery(int count, int grain, const F& fn) {
+    scratch.resize(pool ? pool->Threads() : 1);
+    if (pool) pool->ParallelFor(count, grain, fn);
+    else
+        for (int q = 0; q < count; q++) fn(q, 0);
+}
+
+void SceneQuery::BeginBatch() {
+    queryStarts.assign(1, 0);
+    candidates.clear();
+}
+
+void SceneQuery::GatherBox(const Aabb& box, const QueryFilter& filter) {
+    size_t first = candidates.size();
+    if (!box.IsEmpty()) {
+        index->Query(box, candidates);
+        if (tiles) {
+            tiles->Statics(box, candidates);
+            tiles->Baked(box, candidates);
+        }
+    }
+    EndGather(first, filter);
+}
+
+void SceneQuery::GatherRay(const Ray& ray, const QueryFilter& filter) {
+    size_t first = candidates.size();
+    index->RayQuery(ray.x, ray.y, ray.dx, ray.dy, candidates);
+    if (tiles) tiles->RayStatics(ray.x, ray.y, ray.dx, ray.dy, candidates);
+    EndGather(first, filter);
+}
+
+// The index and the tiles may both report an entity; sorting also puts
+// results in index order
+void SceneQuery::EndGather(size_t first, const QueryFilter& filter) {
+    int n = (int)entities->size();
+    auto begin = candidates.begin() + first;
+    std::sort(begin, candidates.end());
+    auto end = std::unique(begin, candidates.end());
+    end = std::remove_if(begin, end, [&](int k) { return k < 0 || k >= n || !filter.Accepts((*entities)[k], k); });
+    candidates.erase(end, candidates.end());
+    queryStarts.push_back((int)candidates.size());
+}
+
+void SceneQuery::TestOverlaps(std::vector<int>& starts, std::vector<int>& ids) {
+    int count = (int)queryShapes.size();
+    keep.assign(candidates.size(), 0);
+    ForEachQuery(count, 16, [&](int q, int worker) {
+        Scratch &s = scratch[worker];
+        int first = queryStarts[q], last = queryStarts[q + 1];
+        if (first == last) return;
+        s.shapes.Clear();
+        for (int c = first; c < last; c++) s.shapes.Push(ShapeOf((*entities)[candidates[c]]));
+        ObbKernel::OverlapMasks(queryShapes[q], s.shapes, s.masks);
+        for (int h = 0; h < last - first; h++) keep[first + h] = (s.masks[h / ObbSoA::kBlock] >> (h % ObbSoA::kBlock)) & 1;
+    });
+
+    starts.assign(1, 0);
+    ids.clear();
+    for (int q = 0; q < count; q++) {
+        for (int c = queryStarts[q]; c < queryStarts[q + 1]; c++)
+            if (keep[c]) ids.push_back(candidates[c]);
+        starts.push_back((int)ids.size());
+    }
+}
+
+void SceneQuery::RayCastBatch(const std::vector<Ray>& rays, const QueryFilter& filter, std::vector<RayHit>& hits) {
+    BeginBatch();
+    for (const Ray &r : rays) GatherRay(r, filter);
+    hits.assign(rays.size(), RayHit());
+    // Candidates are in index order, so the lower index wins a tie
+    ForEachQuery((int)rays.size(), 16, [&](int q, int) {
+        const Ray &ray = rays[q];
+        RayHit &best = hits[q];
+        for (int c = queryStarts[q]; c < queryStarts[q + 1]; c++) {
+            float fraction, nx, ny;
+            if (!RayObb(ray, ShapeOf((*entities)[candidates[c]]), fraction, nx, ny) || fraction >= best.fraction) continue;
+            best = {candidates[c], fraction, ray.x + ray.dx * fraction, ray.y + ray.dy * fraction, nx, ny};
+        }
+    });
+}
+
+void SceneQuery::OverlapBoxBatch(const std::vector<Aabb>& boxes, const QueryFilter& filter, std::vector<int>& starts, std::vector<int>& ids) {
+    BeginBatch();
+    queryShapes.clear();
+    for (const Aabb &b : boxes) {
+        GatherBox(b, filter);
+        queryShapes.push_back(Obb::Around((b.minX + b.maxX) * 0.5f, (b.minY + b.maxY) * 0.5f, (b.maxX - b.minX) * 0.5f, (b.maxY - b.minY) * 0.5f, 0));
+    }
+    TestOverlaps(starts, ids);
+}
+
+// A point is a box with no extent; the kernel's strict compares then ask
+// whether it is inside
+void SceneQuery::OverlapPointBatch(const std::vector<std::pair<float, float>>& points, const QueryFilter& filter,
+                                   std::vector<int>& starts, std::vector<int>& ids) {
+    BeginBatch();
+    queryShapes.clear();
+    for (const auto &p : points) {
+        GatherBox({p.first, p.second, p.first, p.second}, filter);
+        queryShapes.push_back(Obb{p.first, p.second, 0, 0});
+    }
+    TestOverlaps(starts, ids);
+}
+
+bool SceneQuery::RayCast(const Ray& ray, const QueryFilter& filter, RayHit& hit) {
+    oneRay.assign(1, ray);
+    RayCastBatch(oneRay, filter, oneHit);
+    hit = oneHit[0];
+    return hit.entity >= 0;
+}
+
+void SceneQuery::OverlapBox(const Aabb& box, const QueryFilter& filter, std::vector<int>& out) {
+    oneBox.assign(1, box);
+    OverlapBoxBatch(oneBox, filter, oneStarts, oneIds);
+    out.insert(out.end(), oneIds.begin(), oneIds.end());
+}
+
+void SceneQuery::OverlapPoint(float x, float y, const QueryFilter& filter, std::vector<int>& out) {
+    onePoint.assign(1, {x, y});
+    OverlapPointBatch(onePoint, filter, oneStarts, oneIds);
+    out.insert(out.end(), oneIds.begin(), oneIds.end());
+}
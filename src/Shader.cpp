@@ -0,0 +1,60 @@
+#include "Shader.h"
+#include <glad/glad.h>
+#include <iostream>
+
+static const char* uniformNames[(int)UniformSlot::Count] = {
+    "view",
+    "transform",
+    "tint",
+    "alpha",
+    "uvRect",
+    "layer",
+    "tex",
+    "texArray",
+};
+
+ShaderProgram::ShaderProgram() : id(0) {
+    for (int &l : locations) l = -1;
+}
+
+unsigned int ShaderProgram::Compile(unsigned int type, const char* src) {
+    unsigned int s = glCreateShader(type);
+    glShaderSource(s, 1, &src, 0);
+    glCompileShader(s);
+    int ok = 0;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(s, sizeof(log), nullptr, log);
+        std::cerr << "Shader compile error: " << log << std::endl;
+    }
+    return s;
+}
+
+bool ShaderProgram::Build(const char* vSrc, const char* fSrc) {
+    unsigned int vs = Compile(GL_VERTEX_SHADER, vSrc);
+    unsigned int fs = Compile(GL_FRAGMENT_SHADER, fSrc);
+    id = glCreateProgram();
+    glAttachShader(id, vs);
+    glAttachShader(id, fs);
+    glLinkProgram(id);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    int ok = 0;
+    glGetProgramiv(id, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetProgramInfoLog(id, sizeof(log), nullptr, log);
+        std::cerr << "Shader link error: " << log << std::endl;
+        return false;
+    }
+
+    // Unused or optimised-out uniforms resolve to -1, which glUniform* ignores
+    for (int i = 0; i < (int)UniformSlot::Count; i++)
+        locations[i] = glGetUniformLocation(id, uniformNames[i]);
+    glUseProgram(id);
+    glUniform1i(locations[(int)UniformSlot::Texture], 0);
+    glUniform1i(locations[(int)UniformSlot::TextureArray], 1);
+    return true;
+}
@@ -0,0 +1,91 @@
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialHash::SpatialHash(float size) : bucketMask(0), stamp(0), cellsVisited(0) {
+    SetCellSize(size);
+}
+
+void SpatialHash::SetCellSize(float size) {
+    cellSize = size;
+    invCell = 1.0f / size;
+}
+
+int SpatialHash::CellCoord(float v) const {
+    return (int)std::floor(v * invCell);
+}
+
+uint32_t SpatialHash::Bucket(int cx, int cy) const {
+    uint32_t h = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u);
+    return h & bucketMask;
+}
+
+void SpatialHash::Build(const std::vector<Aabb>& input) {
+    boxes = input;
+    scratch.clear();
+    oversized.clear();
+    for (int i = 0; i < (int)boxes.size(); i++) {
+        const Aabb &b = boxes[i];
+        if (b.IsEmpty()) continue;
+        int x0 = CellCoord(b.minX), x1 = CellCoord(b.maxX);
+        int y0 = CellCoord(b.minY), y1 = CellCoord(b.maxY);
+        if ((int64_t)(x1 - x0 + 1) * (y1 - y0 + 1) > kMaxCellsPerBox) {
+            oversized.push_back(i);
+            continue;
+        }
+        for (int cy = y0; cy <= y1; cy++)
+            for (int cx = x0; cx <= x1; cx++) scratch.push_back({cx, cy, i});
+    }
+
+    // Power-of-two bucket count around the number of cell entries
+    size_t buckets = 16;
+    while (buckets < scratch.size()) buckets <<= 1;
+    bucketMask = (uint32_t)buckets - 1;
+    bucketStart.assign(buckets + 1, 0);
+    for (const Cell &c : scratch) bucketStart[Bucket(c.cx, c.cy) + 1]++;
+    for (size_t b = 1; b <= buckets; b++) bucketStart[b] += bucketStart[b - 1];
+
+    cells.resize(scratch.size());
+    cursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+    for (const Cell &c : scratch) cells[cursor[Bucket(c.cx, c.cy)]++] = c;
+
+    marks.assign(boxes.size(), 0);
+    stamp = 0;
+}
+
+void SpatialHash::Query(const Aabb& box, std::vector<int>& out) {
+    cellsVisited = 0;
+    if (boxes.empty() || box.IsEmpty()) return;
+    if (++stamp == 0) {
+        std::fill(marks.begin(), marks.end(), 0);
+        stamp = 1;
+    }
+
+    auto report = [&](int id) {
+        if (marks[id] == stamp || !boxes[id].Overlaps(box)) return;
+        marks[id] = stamp;
+        out.push_back(id);
+    };
+
+    for (int id : oversized) report(id);
+
+    int x0 = CellCoord(box.minX), x1 = CellCoord(box.maxX);
+    int y0 = CellCoord(box.minY), y1 = CellCoord(box.maxY);
+    int64_t span = (int64_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+    if (span >= (int64_t)cells.size()) {
+        // Box covers more cells than there are entries; walking them all is cheaper
+        for (const Cell &c : cells) report(c.id);
+        cellsVisited = (int)cells.size();
+        return;
+    }
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            uint32_t b = Bucket(cx, cy);
+            for (uint32_t k = bucketStart[b]; k < bucketStart[b + 1]; k++) {
+                const Cell &c = cells[k];
+                if (c.cx == cx && c.cy == cy) report(c.id);
+            }
+            cellsVisited++;
+        }
+    }
+}
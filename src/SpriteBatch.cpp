@@ -0,0 +1,119 @@
+#include "SpriteBatch.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+SpriteBatch::SpriteBatch() : VAO(0), EBO(0), capacity(0) {}
+
+void SpriteBatch::Init(int maxSprites) {
+    capacity = maxSprites;
+
+    std::vector<unsigned int> idx = QuadIndices(capacity);
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &EBO);
+    glBindVertexArray(VAO);
+    stream.Init(capacity * 4 * sizeof(SpriteVertex));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned int), idx.data(), GL_STATIC_DRAW);
+
+    for (unsigned int loc = 0; loc <= 3; loc++) glEnableVertexAttribArray(loc);
+    glBindBuffer(GL_ARRAY_BUFFER, stream.Id());
+    SetVertexLayout(0);
+}
+
+// Each upload lands somewhere different in the stream buffer, so the
+// attributes are re-pointed at it and the static indices still start at 0
+void SpriteBatch::SetVertexLayout(size_t offset) {
+    GLsizei stride = sizeof(SpriteVertex);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void *)(offset + offsetof(SpriteVertex, x)));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void *)(offset + offsetof(SpriteVertex, u)));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)(offset + offsetof(SpriteVertex, color)));
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (void *)(offset + offsetof(SpriteVertex, layer)));
+}
+
+std::vector<unsigned int> SpriteBatch::QuadIndices(int quads) {
+    std::vector<unsigned int> idx(quads * 6);
+    for (int q = 0; q < quads; q++) {
+        unsigned int b = q * 4;
+        idx[q * 6 + 0] = b + 0;
+        idx[q * 6 + 1] = b + 1;
+        idx[q * 6 + 2] = b + 2;
+        idx[q * 6 + 3] = b + 2;
+        idx[q * 6 + 4] = b + 3;
+        idx[q * 6 + 5] = b + 0;
+    }
+    return idx;
+}
+
+void SpriteBatch::Begin() {
+    keys.clear();
+    quads.clear();
+}
+
+void SpriteBatch::Draw(const TextureRegion& tex, float x, float y, float r, float sx, float sy, const float* color, float alpha) {
+    keys.push_back({tex.texture, tex.IsArray()});
+    quads.resize(quads.size() + 4);
+    ExpandQuad(tex, x, y, r, sx, sy, color, alpha, &quads[quads.size() - 4]);
+}
+
+void SpriteBatch::ExpandQuad(const TextureRegion& tex, float x, float y, float r, float sx, float sy, const float* color, float alpha, SpriteVertex* out) {
+    float c = 1.0f, s = 0.0f;
+    if (r != 0.0f) {
+        c = cos(r);
+        s = sin(r);
+    }
+    // Half extents of the rotated local X and Y axes
+    float ax = c * sx * 0.5f, ay = s * sx * 0.5f;
+    float bx = -s * sy * 0.5f, by = c * sy * 0.5f;
+    uint32_t col = PackColor(color, alpha);
+    float layer = (float)tex.layer;
+
+    out[0] = {x - ax - bx, y - ay - by, tex.u0, tex.v0, col, layer};
+    out[1] = {x + ax - bx, y + ay - by, tex.u1, tex.v0, col, layer};
+    out[2] = {x + ax + bx, y + ay + by, tex.u1, tex.v1, col, layer};
+    out[3] = {x - ax + bx, y - ay + by, tex.u0, tex.v1, col, layer};
+}
+
+void SpriteBatch::End(GLStateCache& gl, RenderStats& stats) {
+    if (keys.empty()) return;
+
+    gl.BindVertexArray(VAO);
+    int total = (int)keys.size();
+    for (int base = 0; base < total; base += capacity) {
+        int n = std::min(capacity, total - base);
+        SetVertexLayout(stream.Write(&quads[base * 4], n * 4 * sizeof(SpriteVertex)));
+
+        // Never reorder: a run ends wherever the texture changes, even if the
+        // same texture comes back later
+        int runStart = 0;
+        for (int i = 1; i <= n; i++) {
+            if (i == n || keys[base + i].texture != keys[base + runStart].texture) {
+                Flush(runStart, i - runStart, keys[base + runStart], gl, stats);
+                runStart = i;
+            }
+        }
+    }
+    stats.sprites += total;
+}
+
+void SpriteBatch::Flush(int first, int count, const Key& key, GLStateCache& gl, RenderStats& stats) {
+    BindTexture(gl, key.texture, key.array);
+    glDrawElements(GL_TRIANGLES, count * 6, GL_UNSIGNED_INT, (void *)(first * 6 * sizeof(unsigned int)));
+    stats.drawCalls++;
+    stats.vertices += count * 4;
+}
+
+uint32_t SpriteBatch::PackColor(const float* color, float alpha) {
+    auto toByte = [](float v) -> uint32_t {
+        v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+        return (uint32_t)(v * 255.0f + 0.5f);
+    };
+    return toByte(color[0]) | (toByte(color[1]) << 8) | (toByte(color[2]) << 16) | (toByte(alpha) << 24);
+}
+
+void SpriteBatch::BindTexture(GLStateCache& gl, unsigned int texture, bool array) {
+    if (array) gl.BindTexture(1, GL_TEXTURE_2D_ARRAY, texture);
+    else gl.BindTexture(0, GL_TEXTURE_2D, texture);
+}
@@ -0,0 +1,77 @@
+#include "SpriteInstancer.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+
+SpriteInstancer::SpriteInstancer() : VAO(0), capacity(0) {}
+
+void SpriteInstancer::Init(unsigned int quadVBO, unsigned int quadEBO, int maxInstances) {
+    capacity = maxInstances;
+
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+
+    // Per-vertex: the shared unit quad
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), 0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // Per-instance: advanced once per quad
+    stream.Init(capacity * sizeof(SpriteInstance));
+    for (unsigned int loc = 2; loc <= 7; loc++) {
+        glEnableVertexAttribArray(loc);
+        glVertexAttribDivisor(loc, 1);
+    }
+    SetInstanceOffset(0);
+}
+
+// GL 3.3 has no base-instance draws, so each texture run re-points the
+// instance attributes at its first element instead.
+void SpriteInstancer::SetInstanceOffset(size_t base) {
+    GLsizei stride = sizeof(SpriteInstance);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void *)(base + offsetof(SpriteInstance, x)));
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (void *)(base + offsetof(SpriteInstance, rotation)));
+    glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, (void *)(base + offsetof(SpriteInstance, sx)));
+    glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)(base + offsetof(SpriteInstance, color)));
+    glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, stride, (void *)(base + offsetof(SpriteInstance, layer)));
+    glVertexAttribPointer(7, 4, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void *)(base + offsetof(SpriteInstance, uv)));
+}
+
+void SpriteInstancer::Begin() {
+    keys.clear();
+    instances.clear();
+}
+
+void SpriteInstancer::Draw(const TextureRegion& tex, float x, float y, float r, float sx, float sy, const float* color, float alpha) {
+    auto toUnorm16 = [](float v) { return (uint16_t)(v * 65535.0f + 0.5f); };
+    keys.push_back({tex.texture, tex.IsArray()});
+    instances.push_back({x, y, r, sx, sy, SpriteBatch::PackColor(color, alpha),
+                         {toUnorm16(tex.u0), toUnorm16(tex.v0), toUnorm16(tex.u1), toUnorm16(tex.v1)}, (float)tex.layer});
+}
+
+void SpriteInstancer::End(GLStateCache& gl, RenderStats& stats) {
+    if (keys.empty()) return;
+
+    gl.BindVertexArray(VAO);
+    int total = (int)keys.size();
+    for (int base = 0; base < total; base += capacity) {
+        int n = std::min(capacity, total - base);
+        size_t offset = stream.Write(&instances[base], n * sizeof(SpriteInstance));
+
+        int runStart = 0;
+        for (int i = 1; i <= n; i++) {
+            if (i == n || keys[base + i].texture != keys[base + runStart].texture) {
+                SetInstanceOffset(offset + runStart * sizeof(SpriteInstance));
+                SpriteBatch::BindTexture(gl, keys[base + runStart].texture, keys[base + runStart].array);
+                glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, i - runStart);
+                stats.drawCalls++;
+                stats.vertices += (i - runStart) * 4;
+                runStart = i;
+            }
+        }
+    }
+    stats.sprites += total;
+}
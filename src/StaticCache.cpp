@@ -0,0 +1,182 @@
+#include "StaticCache.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+StaticCache::StaticCache() : allDirty(true), EBO(0), eboQuads(0), staticCount(0), rebakes(0) {}
+
+void StaticCache::Init() {
+    glGenBuffers(1, &EBO);
+}
+
+void StaticCache::MarkDirty(int entity) {
+    pending.push_back(entity);
+}
+
+int StaticCache::ChunkFor(const Entity& e) {
+    int32_t cx = (int32_t)std::floor(e.x / kChunkSize);
+    int32_t cy = (int32_t)std::floor(e.y / kChunkSize);
+    uint64_t key = ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    auto it = chunkIndex.find(key);
+    if (it != chunkIndex.end()) return it->second;
+    chunks.emplace_back();
+    chunkIndex[key] = (int)chunks.size() - 1;
+    return (int)chunks.size() - 1;
+}
+
+void StaticCache::Update(const std::vector<Entity>& entities, const std::vector<TextureRegion>& textures, int maxLayer) {
+    if (entities.size() != entityChunk.size()) allDirty = true;
+
+    if (allDirty) {
+        for (Chunk &c : chunks) {
+            c.members.clear();
+            c.dirty = true;
+        }
+        entityChunk.assign(entities.size(), -1);
+        staticCount = 0;
+        for (int i = 0; i < (int)entities.size(); i++) {
+            if (!entities[i].isStatic) continue;
+            int c = ChunkFor(entities[i]);
+            chunks[c].members.push_back(i);
+            entityChunk[i] = c;
+            staticCount++;
+        }
+        allDirty = false;
+    } else {
+        for (int i : pending) {
+            if (i < 0 || i >= (int)entities.size()) continue;
+            int from = entityChunk[i];
+            int to = entities[i].isStatic ? ChunkFor(entities[i]) : -1;
+            if (from >= 0) chunks[from].dirty = true;
+            if (to >= 0) chunks[to].dirty = true;
+            if (from != to) {
+                if (from >= 0) {
+                    std::vector<int> &m = chunks[from].members;
+                    m.erase(std::find(m.begin(), m.end(), i));
+                    staticCount--;
+                }
+                if (to >= 0) {
+                    chunks[to].members.push_back(i);
+                    staticCount++;
+                }
+                entityChunk[i] = to;
+            }
+        }
+    }
+    pending.clear();
+
+    for (Chunk &c : chunks)
+        if (c.dirty) Bake(c, entities, textures, maxLayer);
+}
+
+void StaticCache::Bake(Chunk& chunk, const std::vector<Entity>& entities, const std::vector<TextureRegion>& textures, int maxLayer) {
+    chunk.dirty = false;
+    chunk.runs.clear();
+    chunk.bounds = {1, 1, 0, 0};
+    rebakes++;
+    if (chunk.members.empty()) return;
+
+    auto resolve = [&](TextureHandle h) -> const TextureRegion& {
+        return (h > 0 && h < (int)textures.size()) ? textures[h] : textures[0];
+    };
+    auto layerOf = [&](const Entity& e) { return std::clamp(e.layer, 0, maxLayer); };
+
+    // Same order the render queue would give them: layer, texture, index
+    std::vector<int> &m = chunk.members;
+    std::sort(m.begin(), m.end(), [&](int a, int b) {
+        int la = layerOf(entities[a]), lb = layerOf(entities[b]);
+        if (la != lb) return la < lb;
+        unsigned int ta = resolve(entities[a].texture).texture, tb = resolve(entities[b].texture).texture;
+        if (ta != tb) return ta < tb;
+        return a < b;
+    });
+
+    scratch.resize(m.size() * 4);
+    for (size_t k = 0; k < m.size(); k++) {
+        const Entity &e = entities[m[k]];
+        const TextureRegion &tex = resolve(e.texture);
+        SpriteBatch::ExpandQuad(tex, e.x, e.y, e.rotation, e.sx, e.sy, e.color, 1.0f, &scratch[k * 4]);
+        for (int v = 0; v < 4; v++) {
+            const SpriteVertex &sv = scratch[k * 4 + v];
+            if (k == 0 && v == 0) chunk.bounds = {sv.x, sv.y, sv.x, sv.y};
+            chunk.bounds.minX = std::min(chunk.bounds.minX, sv.x);
+            chunk.bounds.minY = std::min(chunk.bounds.minY, sv.y);
+            chunk.bounds.maxX = std::max(chunk.bounds.maxX, sv.x);
+            chunk.bounds.maxY = std::max(chunk.bounds.maxY, sv.y);
+        }
+
+        int layer = layerOf(e);
+        if (chunk.runs.empty() || chunk.runs.back().layer != layer || chunk.runs.back().texture != tex.texture)
+            chunk.runs.push_back({layer, tex.texture, tex.IsArray(), (int)k, 0});
+        chunk.runs.back().count++;
+    }
+
+    int quads = (int)m.size();
+    if (quads > eboQuads) {
+        // VAOs reference the EBO by name, so respecifying it updates every chunk
+        eboQuads = std::max(quads, eboQuads * 2);
+        std::vector<unsigned int> idx = SpriteBatch::QuadIndices(eboQuads);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned int), idx.data(), GL_STATIC_DRAW);
+    }
+
+    if (!chunk.VAO) {
+        glGenVertexArrays(1, &chunk.VAO);
+        glGenBuffers(1, &chunk.VBO);
+        glBindVertexArray(chunk.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        for (unsigned int loc = 0; loc <= 3; loc++) glEnableVertexAttribArray(loc);
+        SpriteBatch::SetVertexLayout(0);
+        glBindVertexArray(0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
+    size_t bytes = scratch.size() * sizeof(SpriteVertex);
+    if (quads > chunk.quadCapacity) {
+        chunk.quadCapacity = quads;
+        glBufferData(GL_ARRAY_BUFFER, bytes, scratch.data(), GL_STATIC_DRAW);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, scratch.data());
+    }
+}
+
+int StaticCache::Cull(const Aabb& view) {
+    visibleChunks.clear();
+    visibleLayers.reset();
+    int culled = 0;
+    for (int i = 0; i < (int)chunks.size(); i++) {
+        const Chunk &c = chunks[i];
+        if (c.runs.empty()) continue;
+        if (!c.bounds.Overlaps(view)) {
+            culled += (int)c.members.size();
+            continue;
+        }
+        visibleChunks.push_back(i);
+        for (const Run &r : c.runs) visibleLayers.set(r.layer);
+    }
+    return culled;
+}
+
+int StaticCache::NextLayer(int from) const {
+    for (int l = std::max(from, 0); l < (int)visibleLayers.size(); l++)
+        if (visibleLayers.test(l)) return l;
+    return INT_MAX;
+}
+
+void StaticCache::DrawLayers(int firstLayer, int lastLayer, GLStateCache& gl, RenderStats& stats) {
+    for (int i : visibleChunks) {
+        const Chunk &c = chunks[i];
+        for (const Run &r : c.runs) {
+            if (r.layer < firstLayer) continue;
+            if (r.layer > lastLayer) break;
+            gl.BindVertexArray(c.VAO);
+            SpriteBatch::BindTexture(gl, r.texture, r.array);
+            glDrawElements(GL_TRIANGLES, r.count * 6, GL_UNSIGNED_INT, (void *)(r.first * 6 * sizeof(unsigned int)));
+            stats.drawCalls++;
+            stats.vertices += r.count * 4;
+            stats.sprites += r.count;
+        }
+    }
+}
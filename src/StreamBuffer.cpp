@@ -0,0 +1,100 @@
+#include "StreamBuffer.h"
+#include <glad/glad.h>
+#include <SDL.h>
+#include <algorithm>
+#include <cstring>
+
+StreamBuffer::StreamBuffer()
+    : buffer(0), persistent(false), mapped(nullptr), segmentSize(0), cursor(0), frame(0), frameOpen(false), stalls(0) {
+    for (int i = 0; i < kFrames; i++) fences[i] = nullptr;
+}
+
+void StreamBuffer::Init(size_t frameBytes) {
+    // glBufferStorage can resolve even where the driver does not expose it,
+    // so trust the extension string rather than the pointer alone
+    persistent = glBufferStorage && glFenceSync && SDL_GL_ExtensionSupported("GL_ARB_buffer_storage");
+    Allocate(frameBytes);
+}
+
+void StreamBuffer::Allocate(size_t bytes) {
+    // Draws already queued keep the old storage alive until they finish,
+    // so the old buffer can be dropped without waiting on them
+    if (buffer) glDeleteBuffers(1, &buffer);
+    for (int i = 0; i < kFrames; i++) {
+        if (fences[i]) glDeleteSync(fences[i]);
+        fences[i] = nullptr;
+    }
+
+    segmentSize = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    cursor = 0;
+    frame = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        size_t total = segmentSize * kFrames;
+        glBufferStorage(GL_ARRAY_BUFFER, total, nullptr, flags);
+        mapped = (unsigned char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, total, flags);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, segmentSize, nullptr, GL_STREAM_DRAW);
+        mapped = nullptr;
+    }
+}
+
+void StreamBuffer::WaitFence(int index) {
+    if (!fences[index]) return;
+    GLenum r = glClientWaitSync(fences[index], 0, 0);
+    if (r == GL_TIMEOUT_EXPIRED) {
+        stalls++;
+        // Flush so the fence is guaranteed to signal, then wait up to a second
+        while (r == GL_TIMEOUT_EXPIRED)
+            r = glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    }
+    glDeleteSync(fences[index]);
+    fences[index] = nullptr;
+}
+
+size_t StreamBuffer::Write(const void* data, size_t bytes) {
+    size_t aligned = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+
+    if (persistent) {
+        if (!frameOpen) {
+            // Segment written kFrames ago must be done before we reuse it
+            WaitFence(frame);
+            cursor = frame * segmentSize;
+            frameOpen = true;
+        }
+        if (cursor + aligned > (frame + 1) * segmentSize) {
+            // Frame outgrew its segment: double into fresh storage
+            Allocate(std::max(segmentSize * 2, aligned));
+        }
+        memcpy(mapped + cursor, data, bytes);
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        if (cursor + aligned > segmentSize) {
+            // Orphan: the driver hands us new memory while the old storage
+            // drains, so the append below never collides with a pending draw
+            if (aligned > segmentSize) segmentSize = std::max(segmentSize * 2, aligned);
+            glBufferData(GL_ARRAY_BUFFER, segmentSize, nullptr, GL_STREAM_DRAW);
+            cursor = 0;
+        }
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        void *dst = glMapBufferRange(GL_ARRAY_BUFFER, cursor, bytes, access);
+        if (dst) {
+            memcpy(dst, data, bytes);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+    }
+
+    size_t offset = cursor;
+    cursor += aligned;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    return offset;
+}
+
+void StreamBuffer::EndFrame() {
+    if (!persistent || !frameOpen) return;
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame = (frame + 1) % kFrames;
+    frameOpen = false;
+}
@@ -0,0 +1,117 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+#include <cfloat>
+
+uint64_t SweepAndPruneBroadphase::Key(int a, int b) {
+    if (a > b) std::swap(a, b);
+    return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
+
+// Sorts endpoints in place. An element moving left past another is the same
+// event as that one moving right past it, so one rule per case suffices.
+void SweepAndPruneBroadphase::InsertionSort() {
+    for (size_t i = 1; i < endpoints.size(); i++) {
+        Endpoint moving = endpoints[i];
+        size_t j = i;
+        while (j > 0 && endpoints[j - 1].value > moving.value) {
+            const Endpoint &passed = endpoints[j - 1];
+            if (moving.isMin && !passed.isMin) xPairs.insert(Key(moving.id, passed.id));
+            else if (!moving.isMin && passed.isMin) xPairs.erase(Key(moving.id, passed.id));
+            endpoints[j] = passed;
+            j--;
+            swaps++;
+        }
+        endpoints[j] = moving;
+    }
+}
+
+void SweepAndPruneBroadphase::Update(const std::vector<Aabb>& input) {
+    int n = (int)input.size();
+    boxes = input;
+    swaps = 0;
+
+    // Refresh endpoint values; removed bodies are pushed past everything,
+    // which ends their overlaps through the normal swap rules
+    bool anyRemoved = false;
+    for (Endpoint &e : endpoints) {
+        if (e.id >= n || boxes[e.id].IsEmpty()) {
+            e.value = FLT_MAX;
+            anyRemoved = true;
+        } else {
+            e.value = e.isMin ? boxes[e.id].minX : boxes[e.id].maxX;
+        }
+    }
+    // New bodies enter at the right end and sort into place the same way
+    tracked.resize(n, 0);
+    for (int i = 0; i < n; i++) {
+        if (tracked[i] || boxes[i].IsEmpty()) continue;
+        endpoints.push_back({boxes[i].minX, i, true});
+        endpoints.push_back({boxes[i].maxX, i, false});
+        tracked[i] = 1;
+    }
+
+    InsertionSort();
+
+    if (anyRemoved) {
+        auto gone = [&](int id) { return id >= n || boxes[id].IsEmpty(); };
+        while (!endpoints.empty() && endpoints.back().value == FLT_MAX) endpoints.pop_back();
+        for (int i = 0; i < n; i++)
+            if (boxes[i].IsEmpty()) tracked[i] = 0;
+        // Ties at FLT_MAX never swap, so pairs between two removed bodies linger
+        for (auto it = xPairs.begin(); it != xPairs.end();) {
+            if (gone((int)(*it >> 32)) || gone((int)(uint32_t)*it)) it = xPairs.erase(it);
+            else ++it;
+        }
+    }
+
+    // X overlaps filtered by Y give the real pairs; diff against last step
+    previous.swap(pairs);
+    pairs.clear();
+    for (uint64_t key : xPairs) {
+        int a = (int)(key >> 32), b = (int)(uint32_t)key;
+        if (boxes[a].Overlaps(boxes[b])) pairs.push_back({a, b});
+    }
+    std::sort(pairs.begin(), pairs.end());
+    added.clear();
+    removed.clear();
+    std::set_difference(pairs.begin(), pairs.end(), previous.begin(), previous.end(), std::back_inserter(added));
+    std::set_difference(previous.begin(), previous.end(), pairs.begin(), pairs.end(), std::back_inserter(removed));
+
+    // Query window: the widest ordinary box bounds how far left a hit can start
+    float total = 0;
+    int count = 0;
+    for (const Aabb &b : boxes) {
+        if (b.IsEmpty()) continue;
+        total += b.maxX - b.minX;
+        count++;
+    }
+    float limit = count ? kWideFactor * total / count : 0;
+    wide.assign(n, 0);
+    wideIds.clear();
+    maxWidth = 0;
+    for (int i = 0; i < n; i++) {
+        const Aabb &b = boxes[i];
+        if (b.IsEmpty()) continue;
+        float w = b.maxX - b.minX;
+        if (w > limit) {
+            wide[i] = 1;
+            wideIds.push_back(i);
+        } else {
+            maxWidth = std::max(maxWidth, w);
+        }
+    }
+}
+
+void SweepAndPruneBroadphase::Query(const Aabb& box, std::vector<int>& out) {
+    if (box.IsEmpty()) return;
+    for (int id : wideIds)
+        if (boxes[id].Overlaps(box)) out.push_back(id);
+
+    // Any hit's min lies in [box.minX - maxWidth, box.maxX)
+    float from = box.minX - maxWidth;
+    auto it = std::lower_bound(endpoints.begin(), endpoints.end(), from,
+                               [](const Endpoint& e, float v) { return e.value < v; });
+    for (; it != endpoints.end() && it->value < box.maxX; ++it) {
+        if (it->isMin && !wide[it->id] && boxes[it->id].Overlaps(box)) out.push_back(it->id);
+    }
+}
@@ -0,0 +1,39 @@
+#include "TextureArray.h"
+#include <glad/glad.h>
+#include <algorithm>
+
+std::vector<unsigned int> TextureArrayBuilder::Build(const std::vector<AtlasImage>& images, std::map<std::string, TextureRegion>& regions, std::vector<AtlasImage>& leftovers) {
+    std::map<std::pair<int, int>, std::vector<const AtlasImage*>> bySize;
+    for (const AtlasImage &img : images)
+        bySize[{img.w, img.h}].push_back(&img);
+
+    std::vector<unsigned int> ids;
+    for (auto &[size, group] : bySize) {
+        if (group.size() < 2) {
+            leftovers.push_back(*group[0]);
+            continue;
+        }
+        for (size_t first = 0; first < group.size(); first += kMaxLayers) {
+            int layers = (int)std::min<size_t>(kMaxLayers, group.size() - first);
+            unsigned int id;
+            glGenTextures(1, &id);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, size.first, size.second, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+            for (int l = 0; l < layers; l++) {
+                const AtlasImage *img = group[first + l];
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, l, size.first, size.second, 1, GL_RGBA, GL_UNSIGNED_BYTE, img->pixels);
+                TextureRegion r;
+                r.texture = id;
+                r.layer = l;
+                regions[img->name] = r;
+            }
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
@@ -0,0 +1,149 @@
+#include "TextureAtlas.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+void SkylinePacker::Init(int width, int height) {
+    pageW = width;
+    pageH = height;
+    skyline.clear();
+    skyline.push_back({0, 0, width});
+}
+
+// Lowest y at which a w*h rect can sit with its left edge on node `index`, or -1
+int SkylinePacker::Fit(size_t index, int w, int h) const {
+    int x = skyline[index].x;
+    if (x + w > pageW) return -1;
+    int y = 0;
+    int remaining = w;
+    for (size_t i = index; remaining > 0; i++) {
+        if (i >= skyline.size()) return -1;
+        y = std::max(y, skyline[i].y);
+        if (y + h > pageH) return -1;
+        remaining -= skyline[i].width;
+    }
+    return y;
+}
+
+bool SkylinePacker::Insert(int w, int h, int& outX, int& outY) {
+    int bestTop = INT_MAX, bestWidth = INT_MAX;
+    int best = -1, bestY = 0;
+    for (size_t i = 0; i < skyline.size(); i++) {
+        int y = Fit(i, w, h);
+        if (y < 0) continue;
+        // Lowest top edge first, then the narrowest node to limit waste
+        if (y + h < bestTop || (y + h == bestTop && skyline[i].width < bestWidth)) {
+            bestTop = y + h;
+            bestWidth = skyline[i].width;
+            best = (int)i;
+            bestY = y;
+        }
+    }
+    if (best < 0) return false;
+
+    outX = skyline[best].x;
+    outY = bestY;
+
+    // Raise the skyline under the new rect and trim the nodes it covers
+    Node n = {outX, bestY + h, w};
+    skyline.insert(skyline.begin() + best, n);
+    for (size_t i = best + 1; i < skyline.size();) {
+        Node &prev = skyline[i - 1];
+        int prevRight = prev.x + prev.width;
+        if (skyline[i].x >= prevRight) break;
+        int shrink = prevRight - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width <= 0) skyline.erase(skyline.begin() + i);
+        else break;
+    }
+    // Merge neighbours at the same height
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+    return true;
+}
+
+bool TextureAtlas::Fits(int w, int h) {
+    return w + 2 * kPadding <= kPageSize && h + 2 * kPadding <= kPageSize;
+}
+
+std::vector<unsigned int> TextureAtlas::Build(const std::vector<AtlasImage>& images, std::map<std::string, TextureRegion>& regions) {
+    struct Placement {
+        size_t image;
+        int page, x, y;
+    };
+
+    // Tallest first packs noticeably tighter with a skyline
+    std::vector<size_t> order(images.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (images[a].h != images[b].h) return images[a].h > images[b].h;
+        return images[a].w > images[b].w;
+    });
+
+    std::vector<SkylinePacker> pages;
+    std::vector<Placement> placements;
+    for (size_t idx : order) {
+        const AtlasImage &img = images[idx];
+        int w = img.w + 2 * kPadding, h = img.h + 2 * kPadding;
+        int x = 0, y = 0;
+        int page = -1;
+        for (size_t p = 0; p < pages.size() && page < 0; p++)
+            if (pages[p].Insert(w, h, x, y)) page = (int)p;
+        if (page < 0) {
+            pages.emplace_back();
+            pages.back().Init(kPageSize, kPageSize);
+            if (!pages.back().Insert(w, h, x, y)) continue; // caller should have checked Fits()
+            page = (int)pages.size() - 1;
+        }
+        placements.push_back({idx, page, x + kPadding, y + kPadding});
+    }
+
+    std::vector<unsigned int> ids(pages.size());
+    if (ids.empty()) return ids;
+    glGenTextures((int)ids.size(), ids.data());
+
+    std::vector<unsigned char> pixels((size_t)kPageSize * kPageSize * 4);
+    for (size_t p = 0; p < pages.size(); p++) {
+        std::fill(pixels.begin(), pixels.end(), 0);
+        for (const Placement &pl : placements) {
+            if (pl.page != (int)p) continue;
+            const AtlasImage &img = images[pl.image];
+            // Copy with the border texels repeated into the padding so
+            // linear filtering never pulls in a neighbour
+            for (int ty = -kPadding; ty < img.h + kPadding; ty++) {
+                int sy = std::clamp(ty, 0, img.h - 1);
+                unsigned char *dst = &pixels[(((size_t)(pl.y + ty) * kPageSize) + pl.x - kPadding) * 4];
+                const unsigned char *row = img.pixels + (size_t)sy * img.w * 4;
+                for (int tx = -kPadding; tx < img.w + kPadding; tx++) {
+                    int sx = std::clamp(tx, 0, img.w - 1);
+                    memcpy(dst, row + sx * 4, 4);
+                    dst += 4;
+                }
+            }
+
+            TextureRegion r;
+            r.texture = ids[p];
+            r.u0 = (float)pl.x / kPageSize;
+            r.v0 = (float)pl.y / kPageSize;
+            r.u1 = (float)(pl.x + img.w) / kPageSize;
+            r.v1 = (float)(pl.y + img.h) / kPageSize;
+            regions[img.name] = r;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, ids[p]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, kPageSize, kPageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    return ids;
+}
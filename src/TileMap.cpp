@@ -0,0 +1,237 @@
+#include "TileMap.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+int TileMap::TileCoord(float v) const {
+    return (int)std::floor(v * invTile);
+}
+
+uint64_t TileMap::ChunkKey(int cx, int cy) {
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+const TileMap::Chunk* TileMap::Find(int tx, int ty) const {
+    auto it = chunks.find(ChunkKey(tx >> kChunkBits, ty >> kChunkBits));
+    return it == chunks.end() ? nullptr : &it->second;
+}
+
+TileMap::Chunk& TileMap::At(int tx, int ty) {
+    return chunks[ChunkKey(tx >> kChunkBits, ty >> kChunkBits)];
+}
+
+void TileMap::Clear() {
+    chunks.clear();
+    held.clear();
+    rects.clear();
+    spans.clear();
+    solidTiles = baked = listed = 0;
+}
+
+void TileMap::Build(const std::vector<Entity>& entities, const std::vector<Aabb>& bounds, float size, int skip) {
+    Clear();
+    tileSize = size;
+    invTile = 1.0f / size;
+    held.assign(entities.size(), 0);
+    const int local = kChunkTiles - 1;
+
+    // An edge within a thousandth of a tile of a grid line counts as on it
+    auto onGrid = [&](float v) { return std::fabs(v * invTile - std::round(v * invTile)) < 1e-3f; };
+    for (int i = 0; i < (int)entities.size() && i < (int)bounds.size(); i++) {
+        const Entity &e = entities[i];
+        const Aabb &b = bounds[i];
+        if (i == skip || !e.isStatic || b.IsEmpty()) continue;
+
+        bool aligned = e.rotation == 0 && e.restitution == 0 && e.collisionCategory == kCategory && e.collisionMask == kMask &&
+                       onGrid(b.minX) && onGrid(b.minY) && onGrid(b.maxX) && onGrid(b.maxY);
+        if (aligned) {
+            int x0 = (int)std::lround(b.minX * invTile), x1 = (int)std::lround(b.maxX * invTile);
+            int y0 = (int)std::lround(b.minY * invTile), y1 = (int)std::lround(b.maxY * invTile);
+            if (x1 > x0 && y1 > y0) {
+                for (int ty = y0; ty < y1; ty++)
+                    for (int tx = x0; tx < x1; tx++) At(tx, ty).solid[ty & local] |= 1u << (tx & local);
+                for (int cy = y0 >> kChunkBits; cy <= (y1 - 1) >> kChunkBits; cy++)
+                    for (int cx = x0 >> kChunkBits; cx <= (x1 - 1) >> kChunkBits; cx++)
+                        At(cx << kChunkBits, cy << kChunkBits).owners.push_back(i);
+                held[i] = 1;
+                baked++;
+                continue;
+            }
+        }
+
+        int x0 = TileCoord(b.minX), x1 = TileCoord(b.maxX);
+        int y0 = TileCoord(b.minY), y1 = TileCoord(b.maxY);
+        if ((int64_t)(x1 - x0 + 1) * (y1 - y0 + 1) > kMaxListedTiles) continue;
+        for (int ty = y0; ty <= y1; ty++)
+            for (int tx = x0; tx <= x1; tx++) At(tx, ty).pending.emplace_back((ty & local) << kChunkBits | (tx & local), i);
+        held[i] = 1;
+        listed++;
+    }
+
+    // Counting sort of each chunk's lists by tile
+    for (auto &entry : chunks) {
+        Chunk &c = entry.second;
+        for (uint32_t row : c.solid) solidTiles += std::popcount(row);
+        if (c.pending.empty()) continue;
+        c.starts.assign(kChunkTiles * kChunkTiles + 1, 0);
+        for (const auto &p : c.pending) c.starts[p.first + 1]++;
+        for (size_t t = 1; t < c.starts.size(); t++) c.starts[t] += c.starts[t - 1];
+        c.items.resize(c.pending.size());
+        std::vector<int> cursor(c.starts.begin(), c.starts.end() - 1);
+        for (const auto &p : c.pending) c.items[cursor[p.first]++] = p.second;
+        c.pending.clear();
+        c.pending.shrink_to_fit();
+    }
+    MergeRects();
+}
+
+// Splits every row of solid tiles into maximal runs and stacks each run on
+// the rect below when that rect is the same run, then files every rect
+// under each chunk it covers
+void TileMap::MergeRects() {
+    struct Run {
+        int ty, lo, hi;
+    };
+    std::vector<Run> runs;
+    for (const auto &entry : chunks) {
+        int cx = (int)(uint32_t)(entry.first >> 32), cy = (int)(uint32_t)entry.first;
+        for (int y = 0; y < kChunkTiles; y++) {
+            for (uint32_t bits = entry.second.solid[y]; bits;) {
+                int lo = std::countr_zero(bits);
+                int len = std::countr_one(bits >> lo);
+                runs.push_back({cy * kChunkTiles + y, cx * kChunkTiles + lo, cx * kChunkTiles + lo + len - 1});
+                bits = len + lo >= 32 ? 0 : bits & ~0u << (lo + len);
+            }
+        }
+    }
+    std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.ty != b.ty ? a.ty < b.ty : a.lo < b.lo; });
+
+    // Pieces of one run split by chunk edges are joined first
+    size_t joined = 0;
+    for (size_t r = 0; r < runs.size(); r++) {
+        if (joined > 0 && runs[joined - 1].ty == runs[r].ty && runs[joined - 1].hi + 1 == runs[r].lo) runs[joined - 1].hi = runs[r].hi;
+        else runs[joined++] = runs[r];
+    }
+    runs.resize(joined);
+
+    // Rows are in order of lo, so each run meets its match below in one pass
+    std::vector<int> rectOf(runs.size());
+    size_t rowStart = 0, below = 0, belowEnd = 0;
+    for (size_t r = 0; r < runs.size(); r++) {
+        const Run &run = runs[r];
+        if (r > 0 && runs[r - 1].ty != run.ty) {
+            // The row just finished is the one below only if it is adjacent
+            below = runs[r - 1].ty == run.ty - 1 ? rowStart : r;
+            belowEnd = r;
+            rowStart = r;
+        }
+        while (below < belowEnd && runs[below].lo < run.lo) below++;
+        if (below < belowEnd && runs[below].lo == run.lo && runs[below].hi == run.hi) {
+            rectOf[r] = rectOf[below];
+            spans[rectOf[r]].y1 = run.ty;
+        } else {
+            rectOf[r] = (int)spans.size();
+            spans.push_back({run.lo, run.ty, run.hi, run.ty});
+        }
+    }
+
+    rects.resize(spans.size());
+    for (size_t r = 0; r < spans.size(); r++) {
+        const TileSpan &t = spans[r];
+        rects[r] = {{(float)t.x0 * tileSize, (float)t.y0 * tileSize, (float)(t.x1 + 1) * tileSize, (float)(t.y1 + 1) * tileSize}, (uint32_t)r + 1};
+        for (int cy = t.y0 >> kChunkBits; cy <= t.y1 >> kChunkBits; cy++)
+            for (int cx = t.x0 >> kChunkBits; cx <= t.x1 >> kChunkBits; cx++) chunks[ChunkKey(cx, cy)].rects.push_back((int)r);
+    }
+}
+
+bool TileMap::Solid(int tx, int ty) const {
+    const Chunk *c = Find(tx, ty);
+    const int local = kChunkTiles - 1;
+    return c && ((c->solid[ty & local] >> (tx & local)) & 1);
+}
+
+void TileMap::Solids(const Aabb& box, std::vector<TileRect>& out) const {
+    if (rects.empty() || box.IsEmpty()) return;
+    int x0 = TileCoord(box.minX), x1 = TileCoord(box.maxX);
+    int y0 = TileCoord(box.minY), y1 = TileCoord(box.maxY);
+    int cx0 = x0 >> kChunkBits, cy0 = y0 >> kChunkBits;
+    for (int cy = cy0; cy <= y1 >> kChunkBits; cy++) {
+        for (int cx = cx0; cx <= x1 >> kChunkBits; cx++) {
+            auto it = chunks.find(ChunkKey(cx, cy));
+            if (it == chunks.end()) continue;
+            for (int r : it->second.rects) {
+                const TileSpan &t = spans[r];
+                if (t.x1 < x0 || t.x0 > x1 || t.y1 < y0 || t.y0 > y1) continue;
+                // A rect over several chunks is reported by the first the query shares with it
+                if (std::max(t.x0 >> kChunkBits, cx0) != cx || std::max(t.y0 >> kChunkBits, cy0) != cy) continue;
+                out.push_back(rects[r]);
+            }
+        }
+    }
+}
+
+void TileMap::Statics(const Aabb& box, std::vector<int>& out) const {
+    if (chunks.empty() || box.IsEmpty()) return;
+    int x0 = TileCoord(box.minX), x1 = TileCoord(box.maxX);
+    int y0 = TileCoord(box.minY), y1 = TileCoord(box.maxY);
+    const int local = kChunkTiles - 1;
+    size_t first = out.size();
+    for (int ty = y0; ty <= y1; ty++) {
+        for (int tx = x0; tx <= x1; tx++) {
+            const Chunk *c = Find(tx, ty);
+            if (!c || c->starts.empty()) continue;
+            int t = (ty & local) << kChunkBits | (tx & local);
+            out.insert(out.end(), c->items.begin() + c->starts[t], c->items.begin() + c->starts[t + 1]);
+        }
+    }
+    std::sort(out.begin() + first, out.end());
+    out.erase(std::unique(out.begin() + first, out.end()), out.end());
+}
+
+void TileMap::Baked(const Aabb& box, std::vector<int>& out) const {
+    if (chunks.empty() || box.IsEmpty()) return;
+    size_t first = out.size();
+    for (int cy = TileCoord(box.minY) >> kChunkBits; cy <= TileCoord(box.maxY) >> kChunkBits; cy++) {
+        for (int cx = TileCoord(box.minX) >> kChunkBits; cx <= TileCoord(box.maxX) >> kChunkBits; cx++) {
+            const Chunk *c = Find(cx << kChunkBits, cy << kChunkBits);
+            if (c) out.insert(out.end(), c->owners.begin(), c->owners.end());
+        }
+    }
+    std::sort(out.begin() + first, out.end());
+    out.erase(std::unique(out.begin() + first, out.end()), out.end());
+}
+
+// Steps chunk by chunk along the segment, always into whichever chunk
+// border it reaches first
+void TileMap::RayStatics(float x, float y, float dx, float dy, std::vector<int>& out) const {
+    if (chunks.empty()) return;
+    float invChunk = invTile / kChunkTiles;
+    float ox = x * invChunk, oy = y * invChunk;
+    float ex = (x + dx) * invChunk, ey = (y + dy) * invChunk;
+    int cx = (int)std::floor(ox), cy = (int)std::floor(oy);
+    int endX = (int)std::floor(ex), endY = (int)std::floor(ey);
+    int stepX = ex > ox ? 1 : -1, stepY = ey > oy ? 1 : -1;
+    float deltaX = ex != ox ? std::fabs(1.0f / (ex - ox)) : INFINITY;
+    float deltaY = ey != oy ? std::fabs(1.0f / (ey - oy)) : INFINITY;
+    float nextX = ex != ox ? (stepX > 0 ? (float)(cx + 1) - ox : ox - (float)cx) * deltaX : INFINITY;
+    float nextY = ey != oy ? (stepY > 0 ? (float)(cy + 1) - oy : oy - (float)cy) * deltaY : INFINITY;
+
+    size_t first = out.size();
+    int steps = std::abs(endX - cx) + std::abs(endY - cy);
+    for (int k = 0; k <= steps; k++) {
+        const Chunk *c = Find(cx << kChunkBits, cy << kChunkBits);
+        if (c) {
+            out.insert(out.end(), c->owners.begin(), c->owners.end());
+            out.insert(out.end(), c->items.begin(), c->items.end());
+        }
+        if (cx != endX && (cy == endY || nextX < nextY)) {
+            nextX += deltaX;
+            cx += stepX;
+        } else {
+            nextY += deltaY;
+            cy += stepY;
+        }
+    }
+    std::sort(out.begin() + first, out.end());
+    out.erase(std::unique(out.begin() + first, out.end()), out.end());
+}
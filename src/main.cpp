@@ -1,8 +1,14 @@
 #define SDL_MAIN_HANDLED
 #include "Engine.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 int main(int argc, char **argv) {
     Engine engine;
+    // --bench [steps]: print headless broadphase timings instead of opening the editor
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0)
+        return engine.Benchmark(argc > 2 ? std::max(1, std::atoi(argv[2])) : 600);
     engine.Init();
     engine.Run();
     return 0;